@@ -4,8 +4,11 @@
  * This program displays real-time system information including:
  * - CPU usage percentage
  * - RAM usage percentage  
- * - Disk usage percentage
+ * - Pressure stall information for CPU, memory and I/O
+ * - Disk usage percentage per mounted filesystem
+ * - Disk I/O rates, latency and utilization per disk
  * - Network transfer rates
+ * - Interrupt and softirq rates per CPU
  * - System uptime
  * - CPU temperature (if available)
  * - Hostname and current user
@@ -14,487 +17,6088 @@
  */
 
 #include <iostream>
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <locale.h>
 #include <ncurses.h>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <map>
+#include <numeric>
+#include <optional>
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <chrono>
+#include <stdexcept>
+#include <system_error>
 #include <iomanip>
+#include <cerrno>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <net/if.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <sched.h>
 #include <sys/statvfs.h>
 #include <pwd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+
+#include "msysinfo_shm.h"
 
 using ull = unsigned long long;
 
 // =============================================================================
-// SYSTEM INFORMATION FUNCTIONS
+// PERSISTENT FILE READERS
+// =============================================================================
+
+/**
+ * A /proc or /sys file that is opened once and re-read in place with pread().
+ * Re-reading at offset 0 regenerates the file contents, so every tick costs
+ * only the reads themselves instead of open/fstat/read/close plus stream
+ * setup. The descriptor is reopened only when the kernel reports that the
+ * entry has gone away (ENOENT, ESTALE, ENODEV).
+ */
+struct ProcFile {
+    std::string path;
+    int fd = -1;
+    std::vector<char> buffer;  // Reused between reads, always NUL-terminated
+    size_t length = 0;         // Bytes of valid data in buffer
+
+    explicit ProcFile(std::string file_path, size_t initial_capacity = 4096)
+        : path(std::move(file_path)), buffer(initial_capacity) {
+        buffer[0] = '\0';
+    }
+
+    ProcFile(ProcFile &&other) noexcept
+        : path(std::move(other.path)), fd(other.fd),
+          buffer(std::move(other.buffer)), length(other.length) {
+        other.fd = -1;
+    }
+
+    ProcFile(const ProcFile &) = delete;
+    ProcFile &operator=(const ProcFile &) = delete;
+    ProcFile &operator=(ProcFile &&) = delete;
+
+    ~ProcFile() { close_file(); }
+
+    /**
+     * Opens the file if it is not already open
+     * @return true if a valid descriptor is available
+     */
+    bool open_file() {
+        if (fd < 0) {
+            fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        return fd >= 0;
+    }
+
+    void close_file() {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    /**
+     * Re-reads the whole file into the internal buffer
+     * The buffer only grows when the file outgrows it, so steady-state reads
+     * never allocate.
+     * @return true on success, false if the file cannot be read
+     */
+    bool read() {
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            if (!open_file()) return false;
+
+            length = 0;
+            while (true) {
+                // Keep one byte spare for the terminating NUL
+                if (length + 1 >= buffer.size()) {
+                    buffer.resize(buffer.size() * 2);
+                }
+
+                ssize_t bytes = pread(fd, buffer.data() + length,
+                                      buffer.size() - length - 1, (off_t)length);
+                if (bytes > 0) {
+                    length += (size_t)bytes;
+                    continue;
+                }
+                if (bytes == 0) {
+                    buffer[length] = '\0';
+                    return true;
+                }
+                if (errno == EINTR) continue;
+                break;
+            }
+
+            // The entry went away (e.g. device removed): reopen once and retry
+            if (errno != ENOENT && errno != ESTALE && errno != ENODEV) break;
+            close_file();
+        }
+
+        length = 0;
+        buffer[0] = '\0';
+        return false;
+    }
+
+    const char *data() const { return buffer.data(); }
+    size_t size() const { return length; }
+};
+
+// =============================================================================
+// TEXT PARSING
+// =============================================================================
+
+/**
+ * Forward-only tokenizer over a borrowed character range
+ * Tokens are returned as views into the underlying buffer, so scanning a
+ * /proc file never touches the heap. Numeric parsers stop at the first
+ * non-digit and return 0 when no digits are present.
+ */
+struct TextScanner {
+    const char *cursor;
+    const char *end;
+
+    TextScanner(const char *data, size_t size) : cursor(data), end(data + size) {}
+
+    bool at_end() const { return cursor >= end; }
+
+    /** Skips spaces and tabs, but not newlines */
+    void skip_spaces() {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t')) cursor++;
+    }
+
+    /**
+     * Advances past the next newline
+     * @return true if there is more input after it
+     */
+    bool next_line() {
+        const char *newline = (const char *)memchr(cursor, '\n', end - cursor);
+        cursor = newline ? newline + 1 : end;
+        return cursor < end;
+    }
+
+    /**
+     * Reads a whitespace-delimited token, stopping early at delimiter
+     * The delimiter itself is consumed but not included in the token.
+     */
+    std::string_view next_word(char delimiter = ' ') {
+        skip_spaces();
+        const char *start = cursor;
+        while (cursor < end && *cursor != delimiter && *cursor != ' ' &&
+               *cursor != '\t' && *cursor != '\n') {
+            cursor++;
+        }
+        std::string_view word(start, cursor - start);
+        if (cursor < end && *cursor == delimiter) cursor++;
+        return word;
+    }
+
+    /** Parses an unsigned decimal integer after optional spaces */
+    ull next_u64() {
+        skip_spaces();
+        ull value = 0;
+        const char *p = cursor;
+        // A single unsigned compare rejects everything outside '0'..'9'
+        for (unsigned digit; p < end && (digit = (unsigned)(*p - '0')) < 10; ++p) {
+            value = value * 10 + digit;
+        }
+        cursor = p;
+        return value;
+    }
+
+    /** Parses a signed decimal integer after optional spaces */
+    long long next_i64() {
+        skip_spaces();
+        bool negative = cursor < end && *cursor == '-';
+        if (negative) cursor++;
+        long long value = (long long)next_u64();
+        return negative ? -value : value;
+    }
+
+    /**
+     * Parses a non-negative fixed-point number such as "1234.56"
+     * Done by hand: strtod() would honour LC_NUMERIC set by setlocale().
+     */
+    double next_decimal() {
+        double value = (double)next_u64();
+        if (cursor < end && *cursor == '.') {
+            const char *fraction_start = ++cursor;
+            double fraction = (double)next_u64();
+            for (const char *p = fraction_start; p < cursor; ++p) fraction /= 10.0;
+            value += fraction;
+        }
+        return value;
+    }
+};
+
+/**
+ * Perfect hash from a fixed list of keys to their positions in the list
+ * Built at compile time: the constructor searches for a multiplier under
+ * which no two keys share a bucket. The hash only looks at the length and
+ * the first, middle and last characters, so a lookup costs one multiply
+ * and a single comparison against the only key that can match, however
+ * many keys are listed. Tokens that are not in the list (most lines of
+ * /proc/meminfo or /proc/vmstat) fail that comparison. Keys that cannot
+ * be told apart this way fail the build.
+ * @tparam N Number of keys
+ * @tparam BUCKETS Table size, a power of two well above N
+ */
+template <size_t N, size_t BUCKETS = 64>
+struct KeyIndex {
+    static_assert((BUCKETS & (BUCKETS - 1)) == 0 && N * 2 <= BUCKETS, "table too small");
+
+    std::string_view keys[N];
+    unsigned char slots[BUCKETS];  // Position + 1 of the key in each bucket, 0 if empty
+    unsigned seed;
+
+    /** Bucket of a key: multiplicative hash of its length and three characters */
+    static constexpr size_t bucket(std::string_view key, unsigned seed) {
+        if (key.empty()) return 0;
+        unsigned features = (unsigned)key.size() << 24 | (unsigned)(unsigned char)key[0] << 16 |
+                            (unsigned)(unsigned char)key[key.size() / 2] << 8 |
+                            (unsigned char)key.back();
+        unsigned multiplier = 2654435769u + seed * 2u;  // Odd for every seed
+        unsigned bits = 0;
+        while ((1u << bits) < BUCKETS) bits++;
+        return (features * multiplier) >> (32 - bits);
+    }
+
+    constexpr explicit KeyIndex(const std::string_view (&list)[N]) : keys{}, slots{}, seed(0) {
+        for (size_t i = 0; i < N; ++i) keys[i] = list[i];
+
+        for (; seed < 100000; ++seed) {
+            for (unsigned char &slot : slots) slot = 0;
+            bool collision = false;
+            for (size_t i = 0; i < N && !collision; ++i) {
+                unsigned char &slot = slots[bucket(keys[i], seed)];
+                collision = slot != 0;
+                slot = (unsigned char)(i + 1);
+            }
+            if (!collision) return;
+        }
+        throw std::logic_error("no perfect hash seed");  // Fails the constant evaluation
+    }
+
+    /**
+     * Looks up a key
+     * @return Position of key in the list, or -1 if it is not listed
+     */
+    constexpr int find(std::string_view key) const {
+        unsigned char slot = slots[bucket(key, seed)];
+        return slot && keys[slot - 1] == key ? slot - 1 : -1;
+    }
+};
+
+// =============================================================================
+// SYSTEM INFORMATION FUNCTIONS
+// =============================================================================
+
+// Width of the kernel's "unsigned long" counters (/proc/vmstat, diskstats
+// I/O and sector counts); a 32-bit build is assumed to run on a 32-bit kernel
+constexpr int KERNEL_LONG_BITS = (int)sizeof(long) * 8;
+
+/**
+ * Computes how much a cumulative counter grew between two readings
+ * Counters only go backwards when they wrap or are reset, and which one it
+ * was depends on how wide the kernel keeps the counter, so every source
+ * passes its width. A 32-bit counter (/proc/interrupts, the diskstats
+ * millisecond fields) wraps often enough to matter and counts as wrapped
+ * if the wrapped distance is less than half its range. A 64-bit counter is
+ * taken to have wrapped only when the wrapped distance is less than a
+ * quarter of its range. Anything else (driver reload, device re-created,
+ * CPU hotplug) is a reset, and the interval has no meaningful delta.
+ * @param current Latest reading
+ * @param previous Reading one interval earlier
+ * @param delta Output, the growth; 0 after a reset
+ * @param bits Width of the counter in the kernel, 32 or 64
+ * @return false if the counter was reset
+ */
+bool counter_delta(ull current, ull previous, ull &delta, int bits = 64) {
+    delta = current - previous;  // Modulo 2^64, exact for a 64-bit wrap
+    if (current >= previous) return true;
+
+    if (bits == 32) {
+        ull wrapped = 0x100000000ULL - previous + current;
+        if (previous <= 0xFFFFFFFFULL && wrapped < 0x80000000ULL) {
+            delta = wrapped;
+            return true;
+        }
+    } else if (delta < (1ULL << 62)) {
+        return true;
+    }
+    delta = 0;
+    return false;
+}
+
+/**
+ * Rates for one entity (a core, an interface, a disk) over one interval
+ * Collectors pass every counter of the entity through delta() or rate();
+ * if any of them was reset, valid turns false and the entity's rates for
+ * this interval should be reported as unknown rather than as zero or as a
+ * spike. The next interval starts from the new readings and is valid
+ * again.
+ */
+struct CounterRates {
+    double interval;     // Seconds between the readings
+    bool valid = true;   // No counter was reset and the interval is positive
+
+    explicit CounterRates(double seconds) : interval(seconds), valid(seconds > 0.0) {}
+
+    /** Growth of a counter that is bits wide in the kernel, 0 if it was reset */
+    ull delta(ull current, ull previous, int bits = 64) {
+        ull growth;
+        if (!counter_delta(current, previous, growth, bits)) valid = false;
+        return growth;
+    }
+
+    /** Growth of a counter per second, 0.0 if it was reset */
+    double rate(ull current, ull previous, int bits = 64) {
+        ull growth = delta(current, previous, bits);
+        return valid ? (double)growth / interval : 0.0;
+    }
+};
+
+/**
+ * Per-state jiffy counters from the "cpu" lines of /proc/stat
+ * Slot 0 holds the aggregate line, slots 1..N the individual cores. Each state
+ * is its own contiguous array so that the delta pass over hundreds of cores
+ * streams through memory and can be vectorized.
+ */
+struct CpuCounters {
+    std::vector<int> core_id;  // N from "cpuN", or -1 for the aggregate slot
+    std::vector<ull> user, nice, system, idle, iowait, irq, softirq, steal, guest, guest_nice;
+
+    size_t size() const { return core_id.size(); }
+
+    void resize(size_t slots) {
+        core_id.resize(slots);
+        for (std::vector<ull> *state : {&user, &nice, &system, &idle, &iowait,
+                                        &irq, &softirq, &steal, &guest, &guest_nice}) {
+            state->resize(slots);
+        }
+    }
+};
+
+/**
+ * Share of aggregate CPU time spent in each state, as percentages
+ * The kernel already accounts guest time inside user (and guest_nice inside
+ * nice); here they are split out so that the states add up to 100%.
+ */
+struct CpuBreakdown {
+    double user = 0.0;     // User mode, excluding guest
+    double nice = 0.0;     // Niced user mode, excluding guest_nice
+    double system = 0.0;
+    double irq = 0.0;      // Hardware interrupt handlers
+    double softirq = 0.0;  // Softirqs, e.g. network receive processing
+    double steal = 0.0;    // Time taken by the hypervisor for other guests
+    double guest = 0.0;    // Running virtual CPUs (guest + guest_nice)
+    double iowait = 0.0;   // Idle while I/O was outstanding
+    double idle = 0.0;
+};
+
+/**
+ * CPU busy percentages for one sampling interval
+ */
+struct CpuUsage {
+    double total = -1.0;           // Aggregate usage (0.0-100.0), or -1.0 if unknown
+    CpuBreakdown breakdown;        // Aggregate usage split by time state
+    std::vector<double> per_core;  // Usage of each online core in cpuN order, -1.0 if unknown
+    std::vector<int> core_ids;     // CPU number N of each per_core entry; gaps mark offline CPUs
+};
+
+/**
+ * Scheduler counters from the lines of /proc/stat after the cpu lines
+ */
+struct SchedulerCounters {
+    ull interrupts = 0;        // intr: interrupts serviced since boot
+    ull context_switches = 0;  // ctxt: context switches since boot
+    ull forks = 0;             // processes: tasks created since boot
+    ull running = 0;           // procs_running: runnable tasks right now
+    ull blocked = 0;           // procs_blocked: tasks waiting for I/O right now
+};
+
+/**
+ * Load and scheduler activity over one sampling interval
+ */
+struct SchedulerActivity {
+    double load[3] = {-1.0, -1.0, -1.0};  // 1, 5 and 15 minute load averages, -1.0 if unknown
+    ull running = 0;                      // Runnable tasks at the sample
+    ull blocked = 0;                      // Tasks in uninterruptible I/O wait at the sample
+    bool rates_valid = false;             // False until two readings exist, and after a reset
+    double context_switches = 0.0;        // Per second
+    double interrupts = 0.0;              // Per second
+    double forks = 0.0;                   // Tasks created per second
+};
+
+/**
+ * Parses the aggregate and every per-core "cpu" line of /proc/stat
+ * Stops at the start of the first line that is not a cpu line.
+ * @param scanner Scanner positioned at the start of /proc/stat
+ * @param counters Output, resized to the number of cpu lines found
+ */
+void parse_cpu_counters(TextScanner &scanner, CpuCounters &counters) {
+    size_t slot = 0;
+
+    do {
+        const char *line_start = scanner.cursor;
+        std::string_view label = scanner.next_word();
+        if (label.size() < 3 || label.substr(0, 3) != "cpu") {
+            scanner.cursor = line_start;
+            break;
+        }
+
+        if (slot == counters.size()) counters.resize(slot + 1);
+
+        int core_id = -1;
+        for (size_t i = 3; i < label.size(); ++i) {
+            core_id = (core_id < 0 ? 0 : core_id * 10) + (label[i] - '0');
+        }
+        counters.core_id[slot] = core_id;
+
+        counters.user[slot] = scanner.next_u64();
+        counters.nice[slot] = scanner.next_u64();
+        counters.system[slot] = scanner.next_u64();
+        counters.idle[slot] = scanner.next_u64();
+        counters.iowait[slot] = scanner.next_u64();
+        counters.irq[slot] = scanner.next_u64();
+        counters.softirq[slot] = scanner.next_u64();
+        counters.steal[slot] = scanner.next_u64();
+        counters.guest[slot] = scanner.next_u64();
+        counters.guest_nice[slot] = scanner.next_u64();
+        slot++;
+    } while (scanner.next_line());
+
+    counters.resize(slot);
+}
+
+/**
+ * Parses the scheduler lines that follow the cpu lines of /proc/stat
+ * The intr line lists every interrupt source after the total; only the
+ * total is read.
+ * @param scanner Scanner positioned after the cpu lines
+ * @param counters Output; counters whose line is missing are 0
+ */
+void parse_stat_totals(TextScanner &scanner, SchedulerCounters &counters) {
+    counters = SchedulerCounters{};
+    if (scanner.at_end()) return;
+
+    do {
+        std::string_view label = scanner.next_word();
+        if (label == "intr") {
+            counters.interrupts = scanner.next_u64();
+        } else if (label == "ctxt") {
+            counters.context_switches = scanner.next_u64();
+        } else if (label == "processes") {
+            counters.forks = scanner.next_u64();
+        } else if (label == "procs_running") {
+            counters.running = scanner.next_u64();
+        } else if (label == "procs_blocked") {
+            counters.blocked = scanner.next_u64();
+        }
+    } while (scanner.next_line());
+}
+
+/**
+ * Reads the load averages from /proc/loadavg
+ * @param load Output, the 1, 5 and 15 minute averages
+ * @return true on success
+ */
+bool get_load_average(double (&load)[3]) {
+    static ProcFile file("/proc/loadavg", 128);
+    if (!file.read()) {
+        for (double &average : load) average = -1.0;
+        return false;
+    }
+
+    TextScanner scanner(file.data(), file.size());
+    for (double &average : load) {
+        average = scanner.next_decimal();
+    }
+    return true;
+}
+
+/**
+ * Computes aggregate and per-core CPU usage and scheduler activity from
+ * /proc/stat, which is read once per sample for both
+ * Keeps the counters of the previous sample to compute deltas. The first
+ * sample only primes the counters and reports 0%. After the set of online
+ * cores changes, or when a core's counters went backwards, the affected
+ * usage is reported as -1.0 (unknown) for one sample.
+ */
+struct CpuSampler {
+    ProcFile stat_file{"/proc/stat", 16384};
+    CpuCounters previous, current;
+    SchedulerCounters previous_scheduler;
+    std::vector<double> busy_percent;  // Scratch, one entry per slot
+    bool primed = false;
+    bool scheduler_primed = false;
+
+    /** Idle jiffies of a slot, iowait included */
+    static ull idle_jiffies(const CpuCounters &counters, size_t i) {
+        return counters.idle[i] + counters.iowait[i];
+    }
+
+    /** Busy jiffies of a slot; guest time is already part of user and nice */
+    static ull busy_jiffies(const CpuCounters &counters, size_t i) {
+        return counters.user[i] + counters.nice[i] + counters.system[i] +
+               counters.irq[i] + counters.softirq[i] + counters.steal[i];
+    }
+
+    /**
+     * Idle jiffies of a slot over the interval
+     * On NO_HZ kernels idle and iowait are estimated for sleeping CPUs and
+     * can step back slightly; such steps count as no idle time rather than
+     * as a reset.
+     */
+    double idle_delta(size_t i) const {
+        return std::max((double)(long long)(current.idle[i] - previous.idle[i]), 0.0) +
+               std::max((double)(long long)(current.iowait[i] - previous.iowait[i]), 0.0);
+    }
+
+    /**
+     * Reads /proc/stat and updates usage and activity
+     * @param interval Seconds since the previous call
+     * @param usage Output; total is -1.0 if /proc/stat cannot be read
+     * @param activity Output; only the task counts and rates are updated
+     * @return true on success
+     */
+    bool sample(double interval, CpuUsage &usage, SchedulerActivity &activity) {
+        activity.running = activity.blocked = 0;
+        activity.rates_valid = false;
+        activity.context_switches = activity.interrupts = activity.forks = 0.0;
+        if (!stat_file.read()) {
+            usage.total = -1.0;
+            usage.breakdown = CpuBreakdown();
+            usage.per_core.clear();
+            usage.core_ids.clear();
+            scheduler_primed = false;
+            return false;
+        }
+
+        TextScanner scanner(stat_file.data(), stat_file.size());
+        parse_cpu_counters(scanner, current);
+        sample_scheduler(scanner, interval, activity);
+        const size_t slots = current.size();
+        if (slots == 0) {
+            usage.total = -1.0;
+            usage.breakdown = CpuBreakdown();
+            usage.per_core.clear();
+            usage.core_ids.clear();
+            return false;
+        }
+
+        // A hotplugged core shifts the slots, so start over from this sample
+        usage.core_ids.assign(current.core_id.begin() + 1, current.core_id.end());
+        if (!primed || previous.core_id != current.core_id) {
+            double unknown = primed ? -1.0 : 0.0;
+            std::swap(previous, current);
+            primed = true;
+            usage.total = unknown;
+            usage.breakdown = CpuBreakdown();
+            usage.per_core.assign(slots - 1, unknown);
+            return true;
+        }
+
+        // One branch-free pass over every slot. Idle steps back are clamped
+        // (see idle_delta()); only the busy sum or the total going backwards
+        // means a wrap or reset. Deltas of one interval fit a signed
+        // conversion to double, which unlike the unsigned one has a vector
+        // form.
+        busy_percent.resize(slots);
+        ull backwards = 0;
+        for (size_t i = 0; i < slots; ++i) {
+            ull busy_now = busy_jiffies(current, i), busy_before = busy_jiffies(previous, i);
+            ull total_now = busy_now + idle_jiffies(current, i);
+            ull total_before = busy_before + idle_jiffies(previous, i);
+            backwards |= (ull)(busy_now < busy_before) | (ull)(total_now < total_before);
+            double busy_delta = (double)(long long)(busy_now - busy_before);
+            double total_delta = idle_delta(i) + busy_delta;
+            busy_percent[i] = 100.0 * busy_delta / (total_delta + (double)(total_delta == 0.0));
+        }
+
+        // Rare: redo the slots whose sums went backwards, which means the
+        // counters wrapped or the core's counters were reset
+        if (backwards) {
+            for (size_t i = 0; i < slots; ++i) {
+                CounterRates core(1.0);
+                ull busy_now = busy_jiffies(current, i), busy_before = busy_jiffies(previous, i);
+                ull busy_delta = core.delta(busy_now, busy_before);
+                core.delta(busy_now + idle_jiffies(current, i), busy_before + idle_jiffies(previous, i));
+                double total_delta = idle_delta(i) + (double)busy_delta;
+                if (!core.valid) {
+                    busy_percent[i] = -1.0;
+                } else {
+                    busy_percent[i] = total_delta > 0.0 ? 100.0 * (double)busy_delta / total_delta : 0.0;
+                }
+            }
+        }
+
+        usage.total = busy_percent[0];
+        usage.breakdown = usage.total < 0.0 ? CpuBreakdown() : aggregate_breakdown();
+        usage.per_core.assign(busy_percent.begin() + 1, busy_percent.end());
+        std::swap(previous, current);
+        return true;
+    }
+
+    /**
+     * Parses the rest of /proc/stat and computes scheduler rates
+     * @param scanner Scanner positioned after the cpu lines
+     * @param interval Seconds since the previous call
+     * @param activity Output
+     */
+    void sample_scheduler(TextScanner &scanner, double interval, SchedulerActivity &activity) {
+        SchedulerCounters counters;
+        parse_stat_totals(scanner, counters);
+        activity.running = counters.running;
+        activity.blocked = counters.blocked;
+
+        if (scheduler_primed) {
+            CounterRates rates(interval);
+            activity.context_switches = rates.rate(counters.context_switches,
+                                                   previous_scheduler.context_switches);
+            activity.interrupts = rates.rate(counters.interrupts, previous_scheduler.interrupts);
+            activity.forks = rates.rate(counters.forks, previous_scheduler.forks, KERNEL_LONG_BITS);
+            activity.rates_valid = rates.valid;
+            if (!rates.valid) {
+                activity.context_switches = activity.interrupts = activity.forks = 0.0;
+            }
+        }
+        previous_scheduler = counters;
+        scheduler_primed = true;
+    }
+
+    /**
+     * Splits the aggregate slot's delta into its time states
+     * @return Percentages of the interval spent in each state
+     */
+    CpuBreakdown aggregate_breakdown() const {
+        auto delta = [](const std::vector<ull> &now, const std::vector<ull> &before) {
+            return now[0] > before[0] ? (double)(now[0] - before[0]) : 0.0;
+        };
+
+        double guest = delta(current.guest, previous.guest);
+        double guest_nice = delta(current.guest_nice, previous.guest_nice);
+
+        CpuBreakdown breakdown;
+        breakdown.user = std::max(delta(current.user, previous.user) - guest, 0.0);
+        breakdown.nice = std::max(delta(current.nice, previous.nice) - guest_nice, 0.0);
+        breakdown.system = delta(current.system, previous.system);
+        breakdown.irq = delta(current.irq, previous.irq);
+        breakdown.softirq = delta(current.softirq, previous.softirq);
+        breakdown.steal = delta(current.steal, previous.steal);
+        breakdown.guest = guest + guest_nice;
+        breakdown.iowait = delta(current.iowait, previous.iowait);
+        breakdown.idle = delta(current.idle, previous.idle);
+
+        double total = breakdown.user + breakdown.nice + breakdown.system + breakdown.irq +
+                       breakdown.softirq + breakdown.steal + breakdown.guest +
+                       breakdown.iowait + breakdown.idle;
+        if (total <= 0.0) return CpuBreakdown();
+
+        for (double *state : {&breakdown.user, &breakdown.nice, &breakdown.system,
+                              &breakdown.irq, &breakdown.softirq, &breakdown.steal,
+                              &breakdown.guest, &breakdown.iowait, &breakdown.idle}) {
+            *state = *state * 100.0 / total;
+        }
+        return breakdown;
+    }
+};
+
+/**
+ * Memory figures from /proc/meminfo, in KiB
+ */
+struct MemoryInfo {
+    ull total = 0;
+    ull free = 0;
+    ull available = 0;      // Estimate of memory usable without swapping
+    ull buffers = 0;        // Block device metadata cache
+    ull cached = 0;         // Page cache, shmem included
+    ull shmem = 0;          // tmpfs and shared anonymous memory
+    ull slab_reclaimable = 0;
+    ull slab_unreclaimable = 0;
+    ull dirty = 0;          // Waiting to be written back
+    ull writeback = 0;      // Being written back
+    ull anon = 0;           // Anonymous pages mapped by processes
+    ull mapped = 0;         // Page cache mapped by processes
+    ull swap_total = 0;
+    ull swap_free = 0;
+    ull committed = 0;      // Committed_AS: memory promised to processes
+
+    /**
+     * Memory in use, MemTotal - MemAvailable, as a percentage
+     * @return Usage (0.0-100.0), or -1.0 if MemTotal is missing
+     */
+    double used_percent() const {
+        if (total == 0) return -1.0;
+        return (double)(total - std::min(available, total)) * 100.0 / (double)total;
+    }
+
+    /**
+     * Memory in use besides the page cache and anonymous pages, as free(1)
+     * counts it: kernel stacks, page tables, unreclaimable slab and so on
+     */
+    ull kernel() const {
+        ull reclaimable = free + buffers + cached + slab_reclaimable;
+        ull used = total > reclaimable ? total - reclaimable : 0;
+        return used > anon ? used - anon : 0;
+    }
+
+    /** Page cache that can be reclaimed: buffers, cache and reclaimable slab, without shmem */
+    ull reclaimable_cache() const {
+        ull cache = buffers + cached + slab_reclaimable;
+        return cache > shmem ? cache - shmem : 0;
+    }
+};
+
+/** The /proc/meminfo keys parsed into MemoryInfo, in the order of meminfo_fields */
+constexpr std::string_view meminfo_keys[] = {
+    "MemTotal", "MemFree", "MemAvailable", "Buffers", "Cached", "Shmem",
+    "SReclaimable", "SUnreclaim", "Dirty", "Writeback", "AnonPages", "Mapped",
+    "SwapTotal", "SwapFree", "Committed_AS",
+};
+constexpr ull MemoryInfo::*meminfo_fields[] = {
+    &MemoryInfo::total, &MemoryInfo::free, &MemoryInfo::available, &MemoryInfo::buffers,
+    &MemoryInfo::cached, &MemoryInfo::shmem, &MemoryInfo::slab_reclaimable,
+    &MemoryInfo::slab_unreclaimable, &MemoryInfo::dirty, &MemoryInfo::writeback,
+    &MemoryInfo::anon, &MemoryInfo::mapped, &MemoryInfo::swap_total, &MemoryInfo::swap_free,
+    &MemoryInfo::committed,
+};
+static_assert(std::size(meminfo_keys) == std::size(meminfo_fields), "meminfo tables differ");
+constexpr KeyIndex<std::size(meminfo_keys)> meminfo_index(meminfo_keys);
+
+/**
+ * Parses the contents of /proc/meminfo in a single pass
+ * @param data File contents
+ * @param size Length of data in bytes
+ * @param memory Output; fields whose key is missing are 0
+ * @return true if MemTotal was found
+ */
+bool parse_meminfo(const char *data, size_t size, MemoryInfo &memory) {
+    TextScanner scanner(data, size);
+    memory = MemoryInfo{};
+
+    do {
+        int field = meminfo_index.find(scanner.next_word(':'));
+        if (field >= 0) memory.*meminfo_fields[field] = scanner.next_u64();
+    } while (scanner.next_line());
+
+    return memory.total > 0;
+}
+
+/**
+ * Reads /proc/meminfo
+ * @param memory Output
+ * @return true on success
+ */
+bool get_memory_info(MemoryInfo &memory) {
+    static ProcFile meminfo("/proc/meminfo");
+    if (!meminfo.read()) {
+        memory = MemoryInfo{};
+        return false;
+    }
+    return parse_meminfo(meminfo.data(), meminfo.size(), memory);
+}
+
+/**
+ * Paging and reclaim event counters from /proc/vmstat
+ */
+struct VmstatCounters {
+    ull swap_in = 0;         // pswpin: pages read from swap
+    ull swap_out = 0;        // pswpout: pages written to swap
+    ull major_faults = 0;    // pgmajfault: faults that had to wait for I/O
+    ull scan_kswapd = 0;     // Pages scanned by background reclaim
+    ull scan_direct = 0;     // Pages scanned by allocating tasks themselves
+    ull steal_kswapd = 0;    // Pages reclaimed by background reclaim
+    ull steal_direct = 0;    // Pages reclaimed by allocating tasks
+    ull alloc_stalls = 0;    // Allocations that entered direct reclaim, all zones
+    ull compact_stalls = 0;  // Allocations that entered direct compaction
+    ull oom_kills = 0;
+};
+
+/** The /proc/vmstat keys parsed into VmstatCounters, in the order of vmstat_fields */
+constexpr std::string_view vmstat_keys[] = {
+    "pswpin", "pswpout", "pgmajfault", "pgscan_kswapd", "pgscan_direct",
+    "pgsteal_kswapd", "pgsteal_direct", "allocstall", "allocstall_dma",
+    "allocstall_dma32", "allocstall_normal", "allocstall_movable", "allocstall_device",
+    "compact_stall", "oom_kill",
+};
+constexpr ull VmstatCounters::*vmstat_fields[] = {
+    &VmstatCounters::swap_in, &VmstatCounters::swap_out, &VmstatCounters::major_faults,
+    &VmstatCounters::scan_kswapd, &VmstatCounters::scan_direct, &VmstatCounters::steal_kswapd,
+    &VmstatCounters::steal_direct, &VmstatCounters::alloc_stalls, &VmstatCounters::alloc_stalls,
+    &VmstatCounters::alloc_stalls, &VmstatCounters::alloc_stalls, &VmstatCounters::alloc_stalls,
+    &VmstatCounters::alloc_stalls, &VmstatCounters::compact_stalls, &VmstatCounters::oom_kills,
+};
+static_assert(std::size(vmstat_keys) == std::size(vmstat_fields), "vmstat tables differ");
+constexpr KeyIndex<std::size(vmstat_keys)> vmstat_index(vmstat_keys);
+
+/**
+ * Parses the contents of /proc/vmstat in a single pass
+ * Kernels before 4.8 have one "allocstall" counter, later ones one per
+ * zone; either way they are summed into alloc_stalls.
+ * @param data File contents
+ * @param size Length of data in bytes
+ * @param counters Output; counters whose key is missing are 0
+ * @return true if the file had any of the keys
+ */
+bool parse_vmstat(const char *data, size_t size, VmstatCounters &counters) {
+    TextScanner scanner(data, size);
+    counters = VmstatCounters{};
+    bool found = false;
+
+    do {
+        int field = vmstat_index.find(scanner.next_word());
+        if (field < 0) continue;
+        counters.*vmstat_fields[field] += scanner.next_u64();
+        found = true;
+    } while (scanner.next_line());
+
+    return found;
+}
+
+/**
+ * Per-second paging and reclaim rates over the last interval
+ */
+struct VmstatRates {
+    bool valid = false;  // False until two readings exist, and after a counter reset
+    double swap_in = 0.0;
+    double swap_out = 0.0;
+    double major_faults = 0.0;
+    double scan_kswapd = 0.0;
+    double scan_direct = 0.0;
+    double steal_kswapd = 0.0;
+    double steal_direct = 0.0;
+    double alloc_stalls = 0.0;
+    double compact_stalls = 0.0;
+    double oom_kills = 0.0;
+};
+
+/** Each rate with the counter it is computed from, and its name in the outputs */
+constexpr struct {
+    const char *name;
+    ull VmstatCounters::*counter;
+    double VmstatRates::*rate;
+} vmstat_rates[] = {
+    {"pswpin", &VmstatCounters::swap_in, &VmstatRates::swap_in},
+    {"pswpout", &VmstatCounters::swap_out, &VmstatRates::swap_out},
+    {"pgmajfault", &VmstatCounters::major_faults, &VmstatRates::major_faults},
+    {"pgscan_kswapd", &VmstatCounters::scan_kswapd, &VmstatRates::scan_kswapd},
+    {"pgscan_direct", &VmstatCounters::scan_direct, &VmstatRates::scan_direct},
+    {"pgsteal_kswapd", &VmstatCounters::steal_kswapd, &VmstatRates::steal_kswapd},
+    {"pgsteal_direct", &VmstatCounters::steal_direct, &VmstatRates::steal_direct},
+    {"allocstall", &VmstatCounters::alloc_stalls, &VmstatRates::alloc_stalls},
+    {"compact_stall", &VmstatCounters::compact_stalls, &VmstatRates::compact_stalls},
+    {"oom_kill", &VmstatCounters::oom_kills, &VmstatRates::oom_kills},
+};
+
+/**
+ * Computes paging and reclaim rates from /proc/vmstat
+ * Keeps the counters of the previous read to compute deltas; the file is
+ * re-read through a persistent descriptor, so sampling never allocates.
+ */
+struct VmstatSampler {
+    ProcFile vmstat_file{"/proc/vmstat", 8192};
+    VmstatCounters previous;
+    bool primed = false;
+
+    /**
+     * Reads /proc/vmstat and computes rates against the previous read
+     * @param interval Seconds since the previous call
+     * @param rates Output; valid is false if there is no usable delta
+     * @return true if the file was read
+     */
+    bool sample(double interval, VmstatRates &rates) {
+        rates = VmstatRates{};
+        VmstatCounters current;
+        if (!vmstat_file.read() || !parse_vmstat(vmstat_file.data(), vmstat_file.size(), current)) {
+            primed = false;
+            return false;
+        }
+
+        if (primed) {
+            CounterRates counters(interval);
+            for (const auto &entry : vmstat_rates) {
+                rates.*entry.rate =
+                    counters.rate(current.*entry.counter, previous.*entry.counter, KERNEL_LONG_BITS);
+            }
+            if (counters.valid) {
+                rates.valid = true;
+            } else {
+                rates = VmstatRates{};
+            }
+        }
+        previous = current;
+        primed = true;
+        return true;
+    }
+};
+
+/**
+ * Resources covered by Pressure Stall Information
+ */
+enum PressureResource {
+    PRESSURE_CPU,
+    PRESSURE_MEMORY,
+    PRESSURE_IO,
+    PRESSURE_RESOURCES
+};
+
+/**
+ * One "some" or "full" line of a /proc/pressure file
+ * "some" is the share of time at least one task was stalled on the
+ * resource, "full" the share during which all non-idle tasks were.
+ */
+struct PressureLine {
+    double avg10 = -1.0;  // Percent stalled, kernel average over 10 seconds
+    double avg60 = -1.0;  // Same over 60 seconds
+    ull total = 0;        // Cumulative stall time, in microseconds
+};
+
+/**
+ * Stall figures of one resource
+ */
+struct Pressure {
+    PressureLine some, full;
+    double some_percent = -1.0;  // Percent of the last interval stalled, or -1.0 if unknown
+    double full_percent = -1.0;
+};
+
+/**
+ * Parses the contents of a /proc/pressure file
+ * The cpu file only has a "full" line since Linux 5.13; a missing line
+ * keeps its defaults.
+ * @param data File contents
+ * @param size Length of data in bytes
+ * @param pressure Output
+ * @return true if a "some" line was found
+ */
+bool parse_pressure(const char *data, size_t size, Pressure &pressure) {
+    TextScanner scanner(data, size);
+    bool found = false;
+
+    do {
+        std::string_view kind = scanner.next_word();
+        PressureLine *line = kind == "some" ? &pressure.some : kind == "full" ? &pressure.full : nullptr;
+        if (!line) continue;
+        found |= line == &pressure.some;
+
+        // "avg10=0.12 avg60=0.05 avg300=0.01 total=123456"
+        for (std::string_view key = scanner.next_word('='); !key.empty(); key = scanner.next_word('=')) {
+            if (key == "avg10") {
+                line->avg10 = scanner.next_decimal();
+            } else if (key == "avg60") {
+                line->avg60 = scanner.next_decimal();
+            } else if (key == "total") {
+                line->total = scanner.next_u64();
+            } else {
+                scanner.next_word();
+            }
+        }
+    } while (scanner.next_line());
+
+    return found;
+}
+
+/**
+ * Samples /proc/pressure and arms kernel triggers that report stalls as
+ * they happen
+ * Each trigger makes its file descriptor poll with POLLPRI once tasks
+ * have been stalled on the resource for 150ms within a 1s window, so the
+ * sampler can collect right away instead of on its next tick. Without
+ * CAP_SYS_RESOURCE the kernel only accepts windows that are multiples of
+ * 2s; the trigger then watches 300ms per 2s, the same share. Where
+ * triggers are unavailable (older kernel, psi=0) the figures are still
+ * sampled every tick.
+ */
+struct PressureMonitor {
+    static constexpr const char *TRIGGER = "some 150000 1000000";
+    static constexpr const char *UNPRIVILEGED_TRIGGER = "some 300000 2000000";
+
+    ProcFile files[PRESSURE_RESOURCES] = {
+        ProcFile("/proc/pressure/cpu", 256),
+        ProcFile("/proc/pressure/memory", 256),
+        ProcFile("/proc/pressure/io", 256),
+    };
+    int trigger_fds[PRESSURE_RESOURCES] = {-1, -1, -1};
+    Pressure previous[PRESSURE_RESOURCES];
+    bool primed[PRESSURE_RESOURCES] = {};
+    bool stalled = false;  // A trigger fired since the last sample
+
+    PressureMonitor() {
+        for (int resource = 0; resource < PRESSURE_RESOURCES; ++resource) {
+            trigger_fds[resource] = open_trigger(files[resource].path.c_str());
+        }
+    }
+
+    PressureMonitor(const PressureMonitor &) = delete;
+    PressureMonitor &operator=(const PressureMonitor &) = delete;
+
+    ~PressureMonitor() {
+        for (int fd : trigger_fds) {
+            if (fd >= 0) close(fd);
+        }
+    }
+
+    /**
+     * Registers a stall trigger on a pressure file
+     * @param path Path of the /proc/pressure file
+     * @return Descriptor to poll for POLLPRI, or -1 if triggers are unavailable
+     */
+    static int open_trigger(const char *path) {
+        int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) return -1;
+
+        // The kernel expects the terminating NUL to be written too
+        for (const char *trigger : {TRIGGER, UNPRIVILEGED_TRIGGER}) {
+            if (write(fd, trigger, strlen(trigger) + 1) >= 0) return fd;
+            if (errno != EINVAL) break;
+        }
+        close(fd);
+        return -1;
+    }
+
+    /**
+     * Handles poll() activity on a trigger descriptor
+     * @param resource Resource whose trigger was reported
+     * @param revents Events returned by poll()
+     */
+    void on_trigger(int resource, short revents) {
+        if (revents & (POLLERR | POLLNVAL)) {
+            // The trigger was destroyed; keep sampling on ticks only
+            close(trigger_fds[resource]);
+            trigger_fds[resource] = -1;
+            return;
+        }
+        if (revents & POLLPRI) stalled = true;
+    }
+
+    /**
+     * Reads every pressure file and computes stall shares over the interval
+     * @param interval Seconds since the previous call
+     * @param pressure Output, one entry per resource; -1.0 where unavailable
+     * @param stall_event Output, whether a trigger fired since the last call
+     */
+    void sample(double interval, Pressure (&pressure)[PRESSURE_RESOURCES], bool &stall_event) {
+        for (int resource = 0; resource < PRESSURE_RESOURCES; ++resource) {
+            Pressure &current = pressure[resource];
+            current = Pressure{};
+            if (!files[resource].read() ||
+                !parse_pressure(files[resource].data(), files[resource].size(), current)) {
+                primed[resource] = false;
+                continue;
+            }
+
+            // Microseconds stalled per second, as a percentage
+            if (primed[resource]) {
+                const Pressure &before = previous[resource];
+                CounterRates some(interval);
+                double some_rate = some.rate(current.some.total, before.some.total);
+                if (some.valid) current.some_percent = std::min(some_rate / 1e4, 100.0);
+                if (current.full.avg10 >= 0.0) {
+                    CounterRates full(interval);
+                    double full_rate = full.rate(current.full.total, before.full.total);
+                    if (full.valid) current.full_percent = std::min(full_rate / 1e4, 100.0);
+                }
+            }
+            previous[resource] = current;
+            primed[resource] = true;
+        }
+        stall_event = stalled;
+        stalled = false;
+    }
+};
+
+/**
+ * Reads system uptime in seconds from /proc/uptime
+ * @return Uptime in seconds, or 0.0 on error
+ */
+double get_uptime_seconds() {
+    static ProcFile file("/proc/uptime", 128);
+    if (!file.read()) {
+        return 0.0;
+    }
+
+    TextScanner scanner(file.data(), file.size());
+    return scanner.next_decimal();
+}
+
+/**
+ * Reads disk usage percentage for a given path
+ * @param path Filesystem path to check (default: root "/")
+ * @return Disk usage as percentage (0.0-100.0), or -1.0 on error
+ */
+double get_disk_usage(const char *path = "/") {
+    struct statvfs filesystem_stats;
+    
+    if (statvfs(path, &filesystem_stats) != 0) {
+        return -1.0; // Error getting filesystem stats
+    }
+
+    // Calculate total and available space in bytes
+    ull total_space = (ull)filesystem_stats.f_blocks * filesystem_stats.f_frsize;
+    ull available_space = (ull)filesystem_stats.f_bavail * filesystem_stats.f_frsize;
+
+    if (total_space == 0) return 0.0;
+
+    // Calculate used space percentage
+    double used_percentage = (double)(total_space - available_space) * 100.0 / (double)total_space;
+    return used_percentage;
+}
+
+/**
+ * One mounted filesystem from /proc/self/mountinfo
+ */
+struct MountEntry {
+    std::string mount_point;
+    std::string fs_type;
+    ull device;       // makedev(major, minor), shared by bind mounts
+    bool whole_tree;  // Mounts the filesystem's root rather than a subdirectory
+};
+
+/**
+ * Decodes the octal escapes (\040 for space etc.) used in mountinfo paths
+ */
+std::string unescape_mount_path(std::string_view field) {
+    std::string path;
+    path.reserve(field.size());
+    for (size_t i = 0; i < field.size(); ++i) {
+        if (field[i] == '\\' && i + 3 < field.size() &&
+            field[i + 1] >= '0' && field[i + 1] <= '3') {
+            path += (char)((field[i + 1] - '0') * 64 + (field[i + 2] - '0') * 8 + (field[i + 3] - '0'));
+            i += 3;
+        } else {
+            path += field[i];
+        }
+    }
+    return path;
+}
+
+/**
+ * Checks whether a filesystem type holds no user data (proc, cgroup, tmpfs...)
+ */
+bool is_pseudo_filesystem(std::string_view fs_type) {
+    static const char *const pseudo_types[] = {
+        "autofs", "binfmt_misc", "bpf", "cgroup", "cgroup2", "configfs", "debugfs",
+        "devpts", "devtmpfs", "efivarfs", "fusectl", "fuse.gvfsd-fuse", "fuse.lxcfs",
+        "hugetlbfs", "mqueue", "nsfs", "proc", "pstore", "ramfs", "rpc_pipefs",
+        "securityfs", "selinuxfs", "squashfs", "sysfs", "tmpfs", "tracefs",
+    };
+    for (const char *pseudo : pseudo_types) {
+        if (fs_type == pseudo) return true;
+    }
+    return false;
+}
+
+/**
+ * Parses /proc/self/mountinfo into the filesystems worth reporting
+ * Pseudo filesystems are dropped. An overlay counts as real only at "/",
+ * where it is the root of the container the monitor runs in; elsewhere it
+ * is a container root seen from the host, whose usage is that of the host
+ * disk holding its upper directory. Each device is listed once: bind
+ * mounts of the same filesystem would only repeat its usage. Where a
+ * device is mounted several times, the mount at "/" is kept, so that root
+ * usage is reported even when "/" is a subvolume or bind mount; otherwise
+ * a mount of the filesystem's root is preferred.
+ * @param data File contents
+ * @param size Length of data in bytes
+ * @param mounts Output, in mount order
+ */
+void parse_mountinfo(const char *data, size_t size, std::vector<MountEntry> &mounts) {
+    TextScanner scanner(data, size);
+    mounts.clear();
+
+    // "id parent major:minor root mount_point options [optional...] - type source super_options"
+    while (!scanner.at_end()) {
+        scanner.next_u64();  // Mount ID
+        scanner.next_u64();  // Parent ID
+        ull major = scanner.next_u64();
+        scanner.next_word(':');
+        ull minor = scanner.next_u64();
+        std::string_view root = scanner.next_word();
+        std::string_view mount_point = scanner.next_word();
+        scanner.next_word();  // Mount options
+
+        // Optional fields end at a lone "-"
+        std::string_view field;
+        do {
+            field = scanner.next_word();
+        } while (!field.empty() && field != "-");
+        std::string_view fs_type = scanner.next_word();
+        scanner.next_line();
+
+        if (mount_point.empty() || fs_type.empty() || is_pseudo_filesystem(fs_type)) continue;
+        if (fs_type == "overlay" && mount_point != "/") continue;
+
+        MountEntry entry{unescape_mount_path(mount_point), std::string(fs_type),
+                         (major << 20) | minor, root == "/"};
+        auto same_device = std::find_if(mounts.begin(), mounts.end(), [&](const MountEntry &m) {
+            return m.device == entry.device;
+        });
+        if (same_device == mounts.end()) {
+            mounts.push_back(std::move(entry));
+        } else if (same_device->mount_point != "/" &&
+                   (entry.mount_point == "/" || (!same_device->whole_tree && entry.whole_tree))) {
+            *same_device = std::move(entry);
+        }
+    }
+}
+
+/**
+ * Space usage of one mounted filesystem
+ */
+struct FilesystemUsage {
+    std::string mount_point;
+    std::string fs_type;
+    double usage = -1.0;  // Percentage in use, or -1.0 if unavailable
+    bool hung = false;    // statvfs() did not return in time
+};
+
+/**
+ * A batch of statvfs() calls handed to a worker thread
+ * Shared between the sampler and the worker, so that a worker stuck on a
+ * dead mount can be abandoned: it keeps the batch alive on its own and
+ * exits once the call finally returns.
+ */
+struct StatvfsBatch {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::string> paths;
+    std::vector<double> usage;    // One result per path
+    size_t started = 0;           // Paths whose statvfs() the worker has begun
+    size_t completed = 0;         // Paths done so far
+    bool pending = false;         // Set by the sampler, cleared by the worker
+    bool abandoned = false;       // The worker should exit
+
+    /** Worker thread: runs batches until abandoned */
+    static void run(std::shared_ptr<StatvfsBatch> batch) {
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        while (true) {
+            batch->changed.wait(lock, [&] { return batch->pending || batch->abandoned; });
+            if (batch->abandoned) return;
+
+            // The sampler leaves paths alone while the batch is pending
+            for (size_t i = 0; i < batch->paths.size(); ++i) {
+                const char *path = batch->paths[i].c_str();
+                batch->started = i + 1;
+                lock.unlock();
+                double usage = get_disk_usage(path);
+                lock.lock();
+                if (batch->abandoned) return;
+                batch->usage[i] = usage;
+                batch->completed = i + 1;
+            }
+            batch->pending = false;
+            batch->changed.notify_all();
+        }
+    }
+};
+
+/**
+ * Reports space usage for every real mounted filesystem
+ * The mount table is parsed again only after the kernel flags a change on
+ * /proc/self/mountinfo (POLLPRI on watch_fd(), polled by the sampler
+ * thread). statvfs() runs on a worker thread that the sampler never waits
+ * for: each tick starts a batch and the next tick picks up its results, so
+ * usage lags one tick behind. A mount whose statvfs() is still running
+ * STATVFS_TIMEOUT after the batch started (e.g. a dead NFS server) is
+ * reported as hung and not queried again until the worker stuck on it has
+ * returned.
+ */
+struct FilesystemMonitor {
+    static constexpr std::chrono::milliseconds STATVFS_TIMEOUT{250};
+    static constexpr size_t REMOVED = SIZE_MAX;  // batch_mounts entry of an unmounted path
+
+    /** Per-mount state kept across ticks */
+    struct Mount {
+        MountEntry entry;
+        double usage = -1.0;
+        std::weak_ptr<StatvfsBatch> stuck_worker;  // Alive while a worker hangs on this mount
+    };
+
+    ProcFile mountinfo_file{"/proc/self/mountinfo", 16384};
+    bool mounts_stale = true;
+    std::vector<MountEntry> parsed;  // Scratch for parse_mountinfo()
+    std::vector<Mount> mounts;
+    std::vector<size_t> batch_mounts;  // Index into mounts of each path of the running batch
+    std::chrono::steady_clock::time_point batch_started;
+    std::shared_ptr<StatvfsBatch> worker;
+
+    FilesystemMonitor() { mountinfo_file.open_file(); }
+
+    FilesystemMonitor(const FilesystemMonitor &) = delete;
+    FilesystemMonitor &operator=(const FilesystemMonitor &) = delete;
+
+    ~FilesystemMonitor() { abandon_worker(); }
+
+    /** Descriptor that reports POLLPRI when the mount table changes, or -1 */
+    int watch_fd() const { return mountinfo_file.fd; }
+
+    /** Called when poll() reports an event on watch_fd() */
+    void on_mounts_changed() { mounts_stale = true; }
+
+    /** Re-reads the mount table, keeping the state of mounts that remain */
+    void reload_mounts() {
+        if (!mountinfo_file.read()) return;  // Keep the previous table
+        mounts_stale = false;
+        parse_mountinfo(mountinfo_file.data(), mountinfo_file.size(), parsed);
+
+        // Where each old mount went, so the running batch still lands on
+        // the right mounts
+        std::vector<size_t> moved(mounts.size(), REMOVED);
+        std::vector<Mount> reloaded(parsed.size());
+        for (size_t i = 0; i < parsed.size(); ++i) {
+            for (size_t old = 0; old < mounts.size(); ++old) {
+                if (moved[old] == REMOVED && mounts[old].entry.mount_point == parsed[i].mount_point) {
+                    reloaded[i] = std::move(mounts[old]);
+                    moved[old] = i;
+                    break;
+                }
+            }
+            reloaded[i].entry = std::move(parsed[i]);
+        }
+        mounts.swap(reloaded);
+        for (size_t &index : batch_mounts) {
+            if (index != REMOVED) index = moved[index];
+        }
+    }
+
+    /** Lets the current worker go; it exits once its statvfs() returns */
+    void abandon_worker() {
+        if (!worker) return;
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->abandoned = true;
+        }
+        worker->changed.notify_all();
+        worker.reset();
+    }
+
+    /**
+     * Copies the results of the running batch into mounts, and ends the
+     * batch once it has finished or timed out
+     */
+    void collect_batch() {
+        if (batch_mounts.empty()) return;
+        StatvfsBatch &batch = *worker;
+        std::unique_lock<std::mutex> lock(batch.mutex);
+
+        for (size_t k = 0; k < batch.completed; ++k) {
+            if (batch_mounts[k] != REMOVED) mounts[batch_mounts[k]].usage = batch.usage[k];
+        }
+        if (batch.pending) {
+            if (std::chrono::steady_clock::now() - batch_started < STATVFS_TIMEOUT) return;
+
+            // Only a path the worker is inside statvfs() for is hung; a
+            // worker that has not been scheduled yet is just let go. Mounts
+            // after the hung one keep their previous values.
+            if (batch.started > batch.completed && batch.completed < batch_mounts.size() &&
+                batch_mounts[batch.completed] != REMOVED) {
+                Mount &hung = mounts[batch_mounts[batch.completed]];
+                hung.usage = -1.0;
+                hung.stuck_worker = worker;
+            }
+            lock.unlock();
+            abandon_worker();
+        }
+        batch_mounts.clear();
+    }
+
+    /** Hands every responsive mount to the worker, unless a batch is still running */
+    void start_batch() {
+        if (!batch_mounts.empty()) return;
+        if (!worker) {
+            worker = std::make_shared<StatvfsBatch>();
+            std::thread(StatvfsBatch::run, worker).detach();
+        }
+        StatvfsBatch &batch = *worker;
+        std::lock_guard<std::mutex> lock(batch.mutex);
+
+        for (size_t i = 0; i < mounts.size(); ++i) {
+            if (!mounts[i].stuck_worker.expired()) continue;
+            if (batch_mounts.size() == batch.paths.size()) batch.paths.emplace_back();
+            batch.paths[batch_mounts.size()] = mounts[i].entry.mount_point;
+            batch_mounts.push_back(i);
+        }
+        if (batch_mounts.empty()) return;
+        batch.paths.resize(batch_mounts.size());
+        batch.usage.assign(batch_mounts.size(), -1.0);
+        batch.started = 0;
+        batch.completed = 0;
+        batch.pending = true;
+        batch_started = std::chrono::steady_clock::now();
+        batch.changed.notify_all();
+    }
+
+    /**
+     * Updates usage for all mounts
+     * @param filesystems Output, one entry per mount
+     */
+    void sample(std::vector<FilesystemUsage> &filesystems) {
+        collect_batch();
+        if (mounts_stale) reload_mounts();
+        start_batch();
+
+        filesystems.resize(mounts.size());
+        for (size_t i = 0; i < mounts.size(); ++i) {
+            FilesystemUsage &filesystem = filesystems[i];
+            filesystem.mount_point = mounts[i].entry.mount_point;
+            filesystem.fs_type = mounts[i].entry.fs_type;
+            filesystem.hung = !mounts[i].stuck_worker.expired();
+            filesystem.usage = filesystem.hung ? -1.0 : mounts[i].usage;
+        }
+    }
+};
+
+/**
+ * Cumulative I/O counters for one block device from /proc/diskstats
+ */
+struct DiskCounters {
+    char name[32];          // Kernel device names are at most 31 characters
+    ull reads;              // Reads completed
+    ull sectors_read;       // 512-byte sectors, regardless of the device's block size
+    ull read_ms;            // Time spent on reads
+    ull writes;             // Writes completed
+    ull sectors_written;
+    ull write_ms;           // Time spent on writes
+    ull io_ms;              // Time with at least one request in flight
+};
+
+/**
+ * Parses the contents of /proc/diskstats into devices
+ * The vector is reused between calls like in parse_network_stats().
+ * @param data File contents
+ * @param size Length of data in bytes
+ * @param devices Output, one entry per device in file order
+ */
+void parse_disk_stats(const char *data, size_t size, std::vector<DiskCounters> &devices) {
+    TextScanner scanner(data, size);
+    size_t count = 0;
+
+    // "major minor name reads merged sectors ms writes merged sectors ms in_flight io_ms ..."
+    while (!scanner.at_end()) {
+        scanner.next_u64();  // Major number
+        scanner.next_u64();  // Minor number
+        std::string_view device_name = scanner.next_word();
+        if (!device_name.empty()) {
+            if (count == devices.size()) devices.emplace_back();
+            DiskCounters &device = devices[count++];
+
+            size_t name_length = std::min(device_name.size(), sizeof(device.name) - 1);
+            memcpy(device.name, device_name.data(), name_length);
+            device.name[name_length] = '\0';
+
+            device.reads = scanner.next_u64();
+            scanner.next_u64();  // Reads merged
+            device.sectors_read = scanner.next_u64();
+            device.read_ms = scanner.next_u64();
+            device.writes = scanner.next_u64();
+            scanner.next_u64();  // Writes merged
+            device.sectors_written = scanner.next_u64();
+            device.write_ms = scanner.next_u64();
+            scanner.next_u64();  // Requests in flight
+            device.io_ms = scanner.next_u64();
+        }
+        scanner.next_line();
+    }
+
+    devices.resize(count);
+}
+
+/**
+ * I/O activity of one disk over the last interval
+ */
+struct DiskIo {
+    char name[32];
+    bool valid = false;  // False for a new device or after a counter reset
+    double reads_per_sec = 0.0;
+    double writes_per_sec = 0.0;
+    double read_bytes_per_sec = 0.0;
+    double write_bytes_per_sec = 0.0;
+    double await_ms = 0.0;     // Average time per completed request, queueing included
+    double utilization = 0.0;  // Percentage of the interval with requests in flight
+};
+
+/**
+ * Computes per-disk I/O rates from /proc/diskstats
+ * Only whole disks that have seen I/O since boot are reported: partitions
+ * would count the same I/O twice, and idle loop and ram devices are noise.
+ * Whether a device is a whole disk (i.e. has a /sys/block entry) is looked
+ * up once, when the device first appears.
+ */
+struct DiskIoSampler {
+    ProcFile diskstats_file{"/proc/diskstats", 16384};
+    std::vector<DiskCounters> previous, current;
+    // Name, has /sys/block entry; rebuilt every tick from the devices
+    // looked up, so removed loop, dm or nbd devices do not pile up
+    std::vector<std::pair<std::string, bool>> whole_disk_cache, next_whole_disk_cache;
+
+    /**
+     * Checks whether a device is a whole disk rather than a partition
+     * sysfs spells a '/' in a device name as '!' (e.g. cciss!c0d0).
+     * @param name Device name from /proc/diskstats
+     * @param slot Position of the device in this tick's lookups
+     */
+    bool is_whole_disk(const char *name, size_t slot) {
+        auto cached = whole_disk_cache.end();
+        if (slot < whole_disk_cache.size() && whole_disk_cache[slot].first == name) {
+            cached = whole_disk_cache.begin() + slot;
+        } else {
+            cached = std::find_if(whole_disk_cache.begin(), whole_disk_cache.end(),
+                                  [&](const auto &entry) { return entry.first == name; });
+        }
+        if (cached != whole_disk_cache.end()) {
+            next_whole_disk_cache.push_back(std::move(*cached));
+            cached->first.clear();  // Moved out; must not match again
+            return next_whole_disk_cache.back().second;
+        }
+
+        std::string path = "/sys/block/";
+        const size_t prefix = path.size();
+        path += name;
+        std::replace(path.begin() + prefix, path.end(), '/', '!');
+        bool whole_disk = access(path.c_str(), F_OK) == 0;
+        next_whole_disk_cache.emplace_back(name, whole_disk);
+        return whole_disk;
+    }
+
+    /**
+     * Reads /proc/diskstats and computes rates against the previous read
+     * @param interval Seconds since the previous call
+     * @param disks Output, one entry per active disk; emptied on error
+     * @return true on success
+     */
+    bool sample(double interval, std::vector<DiskIo> &disks) {
+        size_t count = 0;
+        if (!diskstats_file.read()) {
+            disks.clear();
+            return false;
+        }
+        parse_disk_stats(diskstats_file.data(), diskstats_file.size(), current);
+        next_whole_disk_cache.clear();
+
+        for (size_t i = 0; i < current.size(); ++i) {
+            const DiskCounters &device = current[i];
+            if (device.reads + device.writes == 0) continue;
+            if (!is_whole_disk(device.name, next_whole_disk_cache.size())) continue;
+
+            // Devices rarely move, so try the same slot first
+            const DiskCounters *before = nullptr;
+            if (i < previous.size() && strcmp(previous[i].name, device.name) == 0) {
+                before = &previous[i];
+            } else {
+                for (const DiskCounters &candidate : previous) {
+                    if (strcmp(candidate.name, device.name) == 0) {
+                        before = &candidate;
+                        break;
+                    }
+                }
+            }
+
+            if (count == disks.size()) disks.emplace_back();
+            DiskIo &io = disks[count++];
+            io = DiskIo{};
+            memcpy(io.name, device.name, sizeof(io.name));
+            if (!before) continue;
+
+            // Wrapped counters are followed across the wrap (the millisecond
+            // fields are printed as 32-bit values by every kernel); a reset
+            // device (re-added) has no rates this interval
+            CounterRates counters(interval);
+            ull reads = counters.delta(device.reads, before->reads, KERNEL_LONG_BITS);
+            ull writes = counters.delta(device.writes, before->writes, KERNEL_LONG_BITS);
+            ull request_ms = counters.delta(device.read_ms, before->read_ms, 32) +
+                             counters.delta(device.write_ms, before->write_ms, 32);
+            ull sectors_read = counters.delta(device.sectors_read, before->sectors_read, KERNEL_LONG_BITS);
+            ull sectors_written =
+                counters.delta(device.sectors_written, before->sectors_written, KERNEL_LONG_BITS);
+            ull io_ms = counters.delta(device.io_ms, before->io_ms, 32);
+            if (!counters.valid) continue;
+
+            io.valid = true;
+            io.reads_per_sec = (double)reads / interval;
+            io.writes_per_sec = (double)writes / interval;
+            io.read_bytes_per_sec = (double)sectors_read * 512.0 / interval;
+            io.write_bytes_per_sec = (double)sectors_written * 512.0 / interval;
+            io.await_ms = reads + writes > 0 ? (double)request_ms / (double)(reads + writes) : 0.0;
+            io.utilization = std::min((double)io_ms / (interval * 10.0), 100.0);
+        }
+
+        disks.resize(count);
+        std::swap(previous, current);
+        whole_disk_cache.swap(next_whole_disk_cache);
+        return true;
+    }
+};
+
+/**
+ * One reading of /proc/interrupts or /proc/softirqs
+ * Both files have a "CPUn" column per online CPU and a row per interrupt
+ * source. The counts of each row are stored contiguously, row after row,
+ * so the delta between two readings is one pass over a flat array however
+ * many CPUs and sources there are.
+ */
+struct InterruptTable {
+    std::vector<int> cpu_ids;         // N of each "CPUN" column heading
+    std::vector<std::string> labels;  // Row labels without the colon, e.g. "24", "LOC", "NET_RX"
+    std::vector<std::string> names;   // Display names: label and device for numbered IRQs
+    std::vector<ull> counts;          // One row of cpu_ids.size() counts per label
+
+    size_t rows() const { return labels.size(); }
+};
+
+/**
+ * Parses /proc/interrupts or /proc/softirqs
+ * Rows such as ERR or MIS have a single count rather than one per CPU;
+ * the missing columns are 0. Strings and arrays keep their capacity
+ * between parses, so steady-state parsing does not allocate.
+ * @param data File contents
+ * @param size Length of data in bytes
+ * @param table Output
+ * @return true if the header listed at least one CPU
+ */
+bool parse_interrupt_table(const char *data, size_t size, InterruptTable &table) {
+    TextScanner scanner(data, size);
+
+    // Header: "CPU0 CPU1 ..."; offline CPUs have no column
+    table.cpu_ids.clear();
+    for (std::string_view heading = scanner.next_word();
+         heading.size() > 3 && heading.substr(0, 3) == "CPU"; heading = scanner.next_word()) {
+        TextScanner digits(heading.data() + 3, heading.size() - 3);
+        table.cpu_ids.push_back((int)digits.next_u64());
+    }
+    const size_t columns = table.cpu_ids.size();
+    if (columns == 0 || !scanner.next_line()) return false;
+
+    size_t row = 0;
+    do {
+        std::string_view label = scanner.next_word(':');
+        if (label.empty()) continue;
+
+        if (row == table.labels.size()) {
+            table.labels.emplace_back();
+            table.names.emplace_back();
+        }
+        if (table.counts.size() < (row + 1) * columns) table.counts.resize((row + 1) * columns);
+
+        ull *counts = &table.counts[row * columns];
+        size_t column = 0;
+        for (; column < columns; ++column) {
+            scanner.skip_spaces();
+            if (scanner.at_end() || (unsigned)(*scanner.cursor - '0') >= 10) break;
+            counts[column] = scanner.next_u64();
+        }
+        std::fill(counts + column, counts + columns, 0);
+
+        // Numbered IRQs end with the device, e.g. "virtio1-input.0"
+        table.labels[row].assign(label);
+        table.names[row].assign(label);
+        if ((unsigned)(label[0] - '0') < 10) {
+            std::string_view device;
+            for (std::string_view word = scanner.next_word(); !word.empty(); word = scanner.next_word()) {
+                device = word;
+            }
+            if (!device.empty()) {
+                table.names[row] += ' ';
+                table.names[row].append(device);
+            }
+        }
+        row++;
+    } while (scanner.next_line());
+
+    table.labels.resize(row);
+    table.names.resize(row);
+    table.counts.resize(row * columns);
+    return true;
+}
+
+/**
+ * Per-CPU interrupt or softirq rates over the last interval
+ */
+struct InterruptRates {
+    bool valid = false;               // False until two readings with the same layout exist
+    std::vector<int> cpu_ids;         // CPU of each column
+    std::vector<std::string> labels;  // Source of each row, as in the file
+    std::vector<std::string> names;   // Display name of each row
+    std::vector<char> row_valid;      // False for a row whose counters were reset
+    std::vector<float> rates;         // Per second, one row of cpu_ids.size() values per source
+
+    size_t rows() const { return labels.size(); }
+};
+
+/**
+ * Computes per-CPU rates from /proc/interrupts or /proc/softirqs
+ * The rates are invalid for one sample whenever the layout changes (a CPU
+ * goes on- or offline, an IRQ is allocated or freed); a single row whose
+ * counters went backwards is invalid on its own.
+ */
+struct InterruptSampler {
+    ProcFile file;
+    InterruptTable previous, current;
+    bool primed = false;
+
+    explicit InterruptSampler(const char *path) : file(path, 16384) {}
+
+    /**
+     * Reads the file and computes rates against the previous read
+     * @param interval Seconds since the previous call
+     * @param rates Output; emptied if the file cannot be read
+     * @return true on success
+     */
+    bool sample(double interval, InterruptRates &rates) {
+        rates.valid = false;
+        if (!file.read() || !parse_interrupt_table(file.data(), file.size(), current)) {
+            primed = false;
+            rates.cpu_ids.clear();
+            rates.labels.clear();
+            rates.names.clear();
+            rates.row_valid.clear();
+            rates.rates.clear();
+            return false;
+        }
+
+        const size_t rows = current.rows();
+        const size_t cells = current.counts.size();
+        rates.cpu_ids = current.cpu_ids;
+        rates.labels = current.labels;
+        rates.names = current.names;
+        rates.row_valid.assign(rows, 1);
+        rates.rates.assign(cells, 0.0f);
+
+        if (primed && interval > 0.0 && current.cpu_ids == previous.cpu_ids &&
+            current.labels == previous.labels) {
+            // One branch-free pass over every cell of every row
+            const ull *now = current.counts.data();
+            const ull *before = previous.counts.data();
+            float *out = rates.rates.data();
+            const float per_second = (float)(1.0 / interval);
+            bool backwards = false;
+            for (size_t i = 0; i < cells; ++i) {
+                long long delta = (long long)(now[i] - before[i]);
+                backwards |= delta < 0;
+                out[i] = (float)delta * per_second;
+            }
+
+            // Rare: redo the rows with a counter that wrapped (the kernel keeps
+            // them as 32-bit values) or was reset
+            if (backwards) {
+                const size_t columns = current.cpu_ids.size();
+                for (size_t row = 0; row < rows; ++row) {
+                    CounterRates counters(interval);
+                    for (size_t i = row * columns; i < (row + 1) * columns; ++i) {
+                        out[i] = (float)counters.rate(now[i], before[i], 32);
+                    }
+                    if (!counters.valid) {
+                        rates.row_valid[row] = 0;
+                        std::fill(out + row * columns, out + (row + 1) * columns, 0.0f);
+                    }
+                }
+            }
+            rates.valid = true;
+        }
+
+        std::swap(previous, current);
+        primed = true;
+        return true;
+    }
+};
+
+/**
+ * Gets the system hostname
+ * @return Hostname as string, or empty string on error
+ */
+std::string get_hostname() {
+    char hostname_buffer[256];
+    if (gethostname(hostname_buffer, sizeof(hostname_buffer)) == 0) {
+        return std::string(hostname_buffer);
+    }
+    return "Unknown";
+}
+
+/**
+ * Gets the current username
+ * @return Username as string, or empty string on error
+ */
+std::string get_username() {
+    struct passwd *user_info = getpwuid(getuid());
+    if (user_info) {
+        return std::string(user_info->pw_name);
+    }
+    return "Unknown";
+}
+
+/**
+ * Host facts that rarely or never change, resolved once instead of per tick
+ * getpwuid() may go through NSS to LDAP/SSSD and stall, so the username is
+ * looked up only at startup. The hostname is re-read when the kernel
+ * signals a change on /proc/sys/kernel/hostname (POLLPRI), or after a long
+ * TTL on kernels without that notification.
+ */
+struct HostFacts {
+    static constexpr double HOSTNAME_TTL = 300.0;  // Seconds
+
+    std::string hostname;
+    std::string username;
+    int hostname_watch_fd = -1;   // Polled by the sampler thread, or -1
+    bool hostname_stale = true;
+    double hostname_expiry = 0.0;  // Monotonic time of the next forced refresh
+
+    HostFacts() {
+        username = get_username();
+        hostname_watch_fd = ::open("/proc/sys/kernel/hostname", O_RDONLY | O_CLOEXEC);
+    }
+
+    HostFacts(const HostFacts &) = delete;
+    HostFacts &operator=(const HostFacts &) = delete;
+
+    ~HostFacts() {
+        if (hostname_watch_fd >= 0) close(hostname_watch_fd);
+    }
+
+    /** Called when poll() reports an event on hostname_watch_fd */
+    void on_hostname_changed() { hostname_stale = true; }
+
+    /**
+     * Re-resolves anything that is stale
+     * @param now Current monotonic time in seconds
+     */
+    void refresh(double now) {
+        if (hostname_stale || now >= hostname_expiry) {
+            hostname = get_hostname();
+            hostname_stale = false;
+            hostname_expiry = now + HOSTNAME_TTL;
+        }
+    }
+};
+
+/**
+ * CPU temperature from the first working thermal zone
+ * The zone is discovered once (trying thermal_zone0 through thermal_zone9)
+ * and then read through a persistent descriptor. If it stops working, or
+ * none was found, discovery is retried at most once per DISCOVERY_INTERVAL
+ * so hosts without sensors do not probe ten paths every tick.
+ */
+struct ThermalSensor {
+    static constexpr double DISCOVERY_INTERVAL = 60.0;  // Seconds
+
+    std::optional<ProcFile> zone_file;
+    double next_discovery = 0.0;  // Monotonic time of the next discovery attempt
+
+    /**
+     * Reads the temperature from a thermal zone file
+     * @return Temperature in Celsius, or -1.0 if not available
+     */
+    static double read_zone(ProcFile &temp_file) {
+        if (!temp_file.read()) return -1.0;
+
+        TextScanner scanner(temp_file.data(), temp_file.size());
+        long long temperature_value = scanner.next_i64();
+        if (scanner.cursor == temp_file.data()) return -1.0;
+
+        // Most systems report temperature in millidegrees Celsius
+        if (temperature_value > 1000) {
+            return temperature_value / 1000.0;
+        }
+        return (double)temperature_value;
+    }
+
+    /**
+     * Attempts to read CPU temperature
+     * @param now Current monotonic time in seconds
+     * @return Temperature in Celsius, or -1.0 if not available
+     */
+    double read(double now) {
+        if (zone_file) {
+            double temperature = read_zone(*zone_file);
+            if (temperature >= 0) return temperature;
+            zone_file.reset();
+        }
+
+        if (now < next_discovery) return -1.0;
+        next_discovery = now + DISCOVERY_INTERVAL;
+
+        for (int zone = 0; zone < 10; ++zone) {
+            ProcFile candidate("/sys/class/thermal/thermal_zone" + std::to_string(zone) + "/temp", 64);
+            double temperature = read_zone(candidate);
+            if (temperature >= 0) {
+                zone_file.emplace(std::move(candidate));
+                return temperature;
+            }
+        }
+        return -1.0; // Temperature not available
+    }
+};
+
+/**
+ * Cumulative counters for one network interface from /proc/net/dev
+ */
+struct InterfaceStats {
+    char name[IFNAMSIZ];
+    int index;        // ifindex when read over rtnetlink, 0 from /proc/net/dev
+    ull rx_bytes;
+    ull rx_packets;
+    ull rx_errors;
+    ull rx_drops;
+    ull rx_fifo;      // Receive FIFO overruns
+    ull tx_bytes;
+    ull tx_packets;
+    ull tx_errors;
+    ull tx_drops;
+    ull tx_fifo;
+};
+
+/**
+ * Parses the contents of /proc/net/dev into interfaces
+ * The vector is reused between calls, so once it has grown to the number of
+ * interfaces on the host no further allocation takes place.
+ * @param data File contents
+ * @param size Length of data in bytes
+ * @param interfaces Output, one entry per interface in file order
+ */
+void parse_network_stats(const char *data, size_t size, std::vector<InterfaceStats> &interfaces) {
+    TextScanner scanner(data, size);
+    size_t count = 0;
+
+    // Skip the two header lines
+    scanner.next_line();
+    if (!scanner.next_line()) {
+        interfaces.clear();
+        return;
+    }
+
+    // Parse each network interface line: "  name: rx_bytes ... tx_bytes ..."
+    do {
+        std::string_view interface_name = scanner.next_word(':');
+        if (interface_name.empty()) continue;
+
+        if (count == interfaces.size()) interfaces.emplace_back();
+        InterfaceStats &stats = interfaces[count++];
+        stats.index = 0;
+
+        size_t name_length = std::min(interface_name.size(), sizeof(stats.name) - 1);
+        memcpy(stats.name, interface_name.data(), name_length);
+        stats.name[name_length] = '\0';
+
+        // Receive: bytes packets errs drop fifo frame compressed multicast
+        stats.rx_bytes = scanner.next_u64();
+        stats.rx_packets = scanner.next_u64();
+        stats.rx_errors = scanner.next_u64();
+        stats.rx_drops = scanner.next_u64();
+        stats.rx_fifo = scanner.next_u64();
+        for (int i = 0; i < 3; ++i) {
+            scanner.next_u64();
+        }
+
+        // Transmit: bytes packets errs drop fifo colls carrier compressed
+        stats.tx_bytes = scanner.next_u64();
+        stats.tx_packets = scanner.next_u64();
+        stats.tx_errors = scanner.next_u64();
+        stats.tx_drops = scanner.next_u64();
+        stats.tx_fifo = scanner.next_u64();
+    } while (scanner.next_line());
+
+    interfaces.resize(count);
+}
+
+/**
+ * Reads network interface statistics from /proc/net/dev
+ * @param interfaces Output, one entry per interface; emptied on error
+ * @return true on success, false if the file cannot be read
+ */
+bool get_network_stats(std::vector<InterfaceStats> &interfaces) {
+    static ProcFile dev_file("/proc/net/dev", 16384);
+
+    if (!dev_file.read()) {
+        interfaces.clear();
+        return false;
+    }
+
+    parse_network_stats(dev_file.data(), dev_file.size(), interfaces);
+    return true;
+}
+
+/**
+ * Progress of an rtnetlink dump after parsing one received buffer
+ */
+enum class DumpStatus { MORE, DONE, FAILED };
+
+/**
+ * Interface name for an ifindex, from an RTM_GETLINK dump or a link event
+ */
+struct LinkName {
+    int index;
+    char name[IFNAMSIZ];
+    unsigned generation;  // Last stats dump that reported this interface
+
+    bool operator<(const LinkName &other) const { return index < other.index; }
+};
+
+/**
+ * Iterates over the messages of one received buffer of a dump
+ * @param data Messages as received from the socket
+ * @param size Length of data in bytes
+ * @param sequence Sequence number of the dump request; other messages are skipped
+ * @param handle Called with each message of type message_type
+ * @return DONE at the end of the dump, FAILED on an error message, else MORE
+ */
+template <typename Handler>
+DumpStatus for_each_dump_message(const char *data, size_t size, uint32_t sequence,
+                                 uint16_t message_type, Handler &&handle) {
+    int remaining = (int)size;
+    for (const struct nlmsghdr *header = (const struct nlmsghdr *)data; NLMSG_OK(header, remaining);
+         header = NLMSG_NEXT(header, remaining)) {
+        if (header->nlmsg_seq != sequence) continue;
+        if (header->nlmsg_type == NLMSG_DONE) return DumpStatus::DONE;
+        if (header->nlmsg_type == NLMSG_ERROR) return DumpStatus::FAILED;
+        if (header->nlmsg_type == message_type) handle(header);
+    }
+    return DumpStatus::MORE;
+}
+
+/**
+ * Extracts the ifindex and name from an RTM_NEWLINK or RTM_DELLINK message
+ * @return true if the message names an interface
+ */
+bool parse_link_name(const struct nlmsghdr *header, LinkName &link) {
+    const struct ifinfomsg *info = (const struct ifinfomsg *)NLMSG_DATA(header);
+    if (header->nlmsg_len < NLMSG_LENGTH(sizeof(*info))) return false;
+
+    int attributes_length = (int)IFLA_PAYLOAD(header);
+    for (const struct rtattr *attribute = IFLA_RTA(info); RTA_OK(attribute, attributes_length);
+         attribute = RTA_NEXT(attribute, attributes_length)) {
+        if (attribute->rta_type != IFLA_IFNAME) continue;
+
+        link.index = info->ifi_index;
+        link.generation = 0;
+        size_t length = strnlen((const char *)RTA_DATA(attribute),
+                                std::min(RTA_PAYLOAD(attribute), sizeof(link.name) - 1));
+        memcpy(link.name, RTA_DATA(attribute), length);
+        link.name[length] = '\0';
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Parses the RTM_NEWLINK messages of a link dump into ifindex/name pairs
+ * @param links Output, appended to
+ */
+DumpStatus parse_link_names(const char *data, size_t size, uint32_t sequence,
+                            std::vector<LinkName> &links) {
+    return for_each_dump_message(data, size, sequence, RTM_NEWLINK, [&](const struct nlmsghdr *header) {
+        LinkName link;
+        if (parse_link_name(header, link)) links.push_back(link);
+    });
+}
+
+/**
+ * Applies an RTNLGRP_LINK notification to a link table
+ * RTM_NEWLINK adds an interface or renames it, RTM_DELLINK removes it.
+ * Interfaces are created with ever-increasing ifindex values, so inserts
+ * land at the end of the table in practice.
+ * @param links Table sorted by ifindex
+ */
+void apply_link_event(const struct nlmsghdr *header, std::vector<LinkName> &links) {
+    LinkName link;
+    if (header->nlmsg_type != RTM_NEWLINK && header->nlmsg_type != RTM_DELLINK) return;
+    if (!parse_link_name(header, link)) return;
+
+    auto position = std::lower_bound(links.begin(), links.end(), link);
+    bool present = position != links.end() && position->index == link.index;
+    if (header->nlmsg_type == RTM_DELLINK) {
+        if (present) links.erase(position);
+    } else if (present) {
+        memcpy(position->name, link.name, sizeof(link.name));
+    } else {
+        links.insert(position, link);
+    }
+}
+
+/**
+ * Parses the RTM_NEWSTATS messages of an IFLA_STATS_LINK_64 dump
+ * Fills the same fields as parse_network_stats(), with the same meaning:
+ * receive drops include rx_missed_errors, as in /proc/net/dev. Each
+ * interface's counters go to the slot of its entry in the link table, and
+ * the entry is stamped with the dump's generation.
+ * @param links Link table sorted by ifindex
+ * @param generation Stamp for the links this dump reports
+ * @param interfaces Output, one slot per entry of links
+ * @param unknown_index Set if a message came for an ifindex missing from links
+ */
+DumpStatus parse_link_stats(const char *data, size_t size, uint32_t sequence,
+                            std::vector<LinkName> &links, unsigned generation,
+                            std::vector<InterfaceStats> &interfaces, bool &unknown_index) {
+    return for_each_dump_message(data, size, sequence, RTM_NEWSTATS, [&](const struct nlmsghdr *header) {
+        const struct if_stats_msg *message = (const struct if_stats_msg *)NLMSG_DATA(header);
+        const size_t header_space = NLMSG_ALIGN(sizeof(struct if_stats_msg));
+        if (header->nlmsg_len < NLMSG_LENGTH(header_space)) return;
+
+        LinkName key;
+        key.index = (int)message->ifindex;
+        auto link = std::lower_bound(links.begin(), links.end(), key);
+        if (link == links.end() || link->index != key.index) {
+            unknown_index = true;
+            return;
+        }
+
+        int attributes_length = (int)(header->nlmsg_len - NLMSG_LENGTH(header_space));
+        for (const struct rtattr *attribute = (const struct rtattr *)((const char *)message + header_space);
+             RTA_OK(attribute, attributes_length); attribute = RTA_NEXT(attribute, attributes_length)) {
+            if (attribute->rta_type != IFLA_STATS_LINK_64) continue;
+
+            // Attribute data is only 4-byte aligned, and older kernels send
+            // a shorter struct
+            struct rtnl_link_stats64 stats = {};
+            memcpy(&stats, RTA_DATA(attribute), std::min(RTA_PAYLOAD(attribute), sizeof(stats)));
+
+            link->generation = generation;
+            InterfaceStats &interface = interfaces[link - links.begin()];
+            memcpy(interface.name, link->name, sizeof(interface.name));
+            interface.index = link->index;
+            interface.rx_bytes = stats.rx_bytes;
+            interface.rx_packets = stats.rx_packets;
+            interface.rx_errors = stats.rx_errors;
+            interface.rx_drops = stats.rx_dropped + stats.rx_missed_errors;
+            interface.rx_fifo = stats.rx_fifo_errors;
+            interface.tx_bytes = stats.tx_bytes;
+            interface.tx_packets = stats.tx_packets;
+            interface.tx_errors = stats.tx_errors;
+            interface.tx_drops = stats.tx_dropped;
+            interface.tx_fifo = stats.tx_fifo_errors;
+            break;
+        }
+    });
+}
+
+/**
+ * Interface counters over rtnetlink
+ * Each tick sends one RTM_GETSTATS dump filtered to IFLA_STATS_LINK_64, so
+ * the kernel returns only the binary 64-bit counters (about 230 bytes per
+ * interface) instead of formatting a text line per interface for us to
+ * parse back. Plain RTM_GETLINK carries the same counters as IFLA_STATS64,
+ * but inside a ~1.5 KB message with every other link attribute, which
+ * costs more than /proc/net/dev on hosts with many interfaces. RTM_GETLINK
+ * is therefore only used to learn interface names, once at startup.
+ *
+ * After that the link table is kept up to date incrementally from
+ * RTNLGRP_LINK notifications (interfaces added, renamed or removed), read
+ * without blocking before each stats dump. Only if notifications were lost
+ * (ENOBUFS) or cannot be subscribed to is the full name dump repeated.
+ *
+ * The request socket is opened once. If the kernel refuses a request
+ * (seccomp, kernels before 4.7) it is closed and available() turns false.
+ */
+struct NetlinkLinkStats {
+    int fd = -1;
+    int event_fd = -1;             // Subscribed to RTNLGRP_LINK, or -1
+    uint32_t sequence = 0;
+    unsigned generation = 0;       // Number of stats dumps so far
+    bool links_stale = true;       // The link table needs a full dump
+    std::vector<char> buffer;      // Receive buffer, grown if a datagram was truncated
+    std::vector<LinkName> links;   // Sorted by ifindex
+
+    NetlinkLinkStats() : buffer(32768) {
+        fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+        if (fd < 0) return;
+
+        // Subscribe before the first name dump so no change falls in between
+        event_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+        struct sockaddr_nl groups = {};
+        groups.nl_family = AF_NETLINK;
+        groups.nl_groups = RTMGRP_LINK;
+        if (event_fd >= 0 && bind(event_fd, (struct sockaddr *)&groups, sizeof(groups)) != 0) {
+            close(event_fd);
+            event_fd = -1;
+        }
+    }
+
+    NetlinkLinkStats(const NetlinkLinkStats &) = delete;
+    NetlinkLinkStats &operator=(const NetlinkLinkStats &) = delete;
+
+    ~NetlinkLinkStats() { disable(); }
+
+    bool available() const { return fd >= 0; }
+
+    void disable() {
+        if (fd >= 0) close(fd);
+        if (event_fd >= 0) close(event_fd);
+        fd = event_fd = -1;
+    }
+
+    /**
+     * Runs one dump request to completion
+     * @param type Request message type
+     * @param payload Request body following the netlink header
+     * @param length Length of payload in bytes
+     * @param parse Called with each received buffer, returns the dump's progress
+     * @return true if the dump completed
+     */
+    template <typename Parser>
+    bool dump(uint16_t type, const void *payload, size_t length, Parser &&parse) {
+        if (fd < 0) return false;
+
+        struct {
+            struct nlmsghdr header;
+            char body[32];
+        } request = {};
+        request.header.nlmsg_len = (uint32_t)NLMSG_LENGTH(length);
+        request.header.nlmsg_type = type;
+        request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+        request.header.nlmsg_seq = ++sequence;
+        memcpy(NLMSG_DATA(&request.header), payload, length);
+
+        struct sockaddr_nl kernel = {};
+        kernel.nl_family = AF_NETLINK;
+        if (sendto(fd, &request, request.header.nlmsg_len, 0, (struct sockaddr *)&kernel,
+                   sizeof(kernel)) < 0) {
+            if (errno != EINTR && errno != ENOBUFS && errno != EAGAIN) disable();
+            return false;
+        }
+
+        while (true) {
+            // MSG_TRUNC makes recv() report the full datagram length
+            ssize_t received = recv(fd, buffer.data(), buffer.size(), MSG_TRUNC);
+            if (received < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if ((size_t)received > buffer.size()) {
+                // Lost part of the dump; the rest is skipped by sequence number
+                buffer.resize((size_t)received);
+                return false;
+            }
+
+            DumpStatus status = parse(buffer.data(), (size_t)received);
+            if (status == DumpStatus::FAILED) {
+                disable();  // The kernel rejected the request itself
+                return false;
+            }
+            if (status == DumpStatus::DONE) return true;
+        }
+    }
+
+    /** Re-learns the names of all interfaces */
+    bool refresh_links() {
+        struct ifinfomsg request = {};
+        request.ifi_family = AF_UNSPEC;
+        links.clear();
+        bool complete = dump(RTM_GETLINK, &request, sizeof(request), [this](const char *data, size_t size) {
+            return parse_link_names(data, size, sequence, links);
+        });
+        std::sort(links.begin(), links.end());
+        links_stale = !complete;
+        return complete;
+    }
+
+    /** Applies the link notifications received since the last call */
+    void apply_link_events() {
+        if (event_fd < 0) {
+            links_stale = true;  // No notifications: dump whenever unsure
+            return;
+        }
+        while (true) {
+            ssize_t received = recv(event_fd, buffer.data(), buffer.size(), MSG_TRUNC);
+            if (received < 0) {
+                if (errno == EINTR) continue;
+                if (errno == ENOBUFS) links_stale = true;  // Overrun, events lost
+                return;
+            }
+            if ((size_t)received > buffer.size()) {
+                buffer.resize((size_t)received);
+                links_stale = true;
+                continue;
+            }
+
+            int remaining = (int)received;
+            for (const struct nlmsghdr *header = (const struct nlmsghdr *)buffer.data();
+                 NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+                apply_link_event(header, links);
+            }
+        }
+    }
+
+    /**
+     * Dumps the counters of every interface
+     * @param interfaces Output, one entry per interface, sorted by ifindex
+     * @return true on success, false if the caller should fall back
+     */
+    bool read(std::vector<InterfaceStats> &interfaces) {
+        struct if_stats_msg request = {};
+        request.family = AF_UNSPEC;
+        request.filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64);
+
+        if (fd < 0) return false;
+        apply_link_events();
+        if (links_stale && !refresh_links()) return false;
+
+        interfaces.resize(links.size());
+        bool unknown_index = false;
+        ++generation;
+        bool complete = dump(RTM_GETSTATS, &request, sizeof(request), [&](const char *data, size_t size) {
+            return parse_link_stats(data, size, sequence, links, generation, interfaces, unknown_index);
+        });
+        if (!complete) return false;
+
+        // An interface whose notification has not been read yet shows up
+        // from the next tick; without notifications, re-learn all names
+        if (unknown_index && event_fd < 0) links_stale = true;
+
+        // Keep the slots of links this dump reported, in ifindex order;
+        // links that vanished in between are dropped
+        size_t count = 0;
+        for (size_t i = 0; i < links.size(); ++i) {
+            if (links[i].generation != generation) continue;
+            if (count != i) interfaces[count] = interfaces[i];
+            count++;
+        }
+        interfaces.resize(count);
+        return true;
+    }
+};
+
+/**
+ * Reads interface counters over rtnetlink where possible, and from
+ * /proc/net/dev otherwise (e.g. rtnetlink blocked by a seccomp filter)
+ * @param netlink rtnetlink reader
+ * @param interfaces Output, one entry per interface; emptied on error
+ * @return true on success
+ */
+bool read_interface_counters(NetlinkLinkStats &netlink, std::vector<InterfaceStats> &interfaces) {
+    if (netlink.read(interfaces)) return true;
+    return get_network_stats(interfaces);
+}
+
+/**
+ * Per-second rates of one network interface over the last interval
+ */
+struct InterfaceRates {
+    char name[IFNAMSIZ];
+    bool valid = false;  // False for a new interface or after a counter reset
+    double rx_bytes = 0.0;
+    double rx_packets = 0.0;
+    double rx_errors = 0.0;
+    double rx_drops = 0.0;
+    double rx_fifo = 0.0;
+    double tx_bytes = 0.0;
+    double tx_packets = 0.0;
+    double tx_errors = 0.0;
+    double tx_drops = 0.0;
+    double tx_fifo = 0.0;
+};
+
+/**
+ * Finds an interface's entry in the previous reading
+ * Readings over rtnetlink are matched by ifindex, so a renamed interface
+ * keeps its baseline and a new interface that reuses a name starts from
+ * its own counters; they are sorted by ifindex, which allows a binary
+ * search. Readings from /proc/net/dev only have the name. The interface
+ * set rarely changes, so the same slot is tried first.
+ * @param previous Previous reading
+ * @param interface Interface from the current reading
+ * @param slot Position of interface in the current reading
+ * @return The previous entry, or nullptr if the interface is new
+ */
+const InterfaceStats *find_previous_interface(const std::vector<InterfaceStats> &previous,
+                                              const InterfaceStats &interface, size_t slot) {
+    auto same = [&interface](const InterfaceStats &candidate) {
+        if (interface.index && candidate.index) return candidate.index == interface.index;
+        return strcmp(candidate.name, interface.name) == 0;
+    };
+    if (slot < previous.size() && same(previous[slot])) return &previous[slot];
+
+    if (interface.index && !previous.empty() && previous[0].index) {
+        auto found = std::lower_bound(previous.begin(), previous.end(), interface.index,
+                                      [](const InterfaceStats &entry, int index) {
+                                          return entry.index < index;
+                                      });
+        return found != previous.end() && found->index == interface.index ? &*found : nullptr;
+    }
+    for (const InterfaceStats &candidate : previous) {
+        if (same(candidate)) return &candidate;
+    }
+    return nullptr;
+}
+
+/**
+ * Computes per-interface rates between two readings of the same interface
+ * Counters that wrapped are followed across the wrap; if any was reset
+ * (driver reload, interface re-created) the rates are zero and marked
+ * invalid for this interval.
+ * @param now Current counters
+ * @param before Previous counters, or nullptr for an interface that just
+ *        appeared, which has no valid rates until it has a baseline
+ * @param interval Seconds between the readings
+ * @param rates Output
+ */
+void compute_interface_rates(const InterfaceStats &now, const InterfaceStats *before,
+                             double interval, InterfaceRates &rates) {
+    rates = InterfaceRates{};
+    memcpy(rates.name, now.name, sizeof(rates.name));
+    if (!before) return;
+
+    CounterRates counters(interval);
+    auto rate = [&counters](ull current, ull previous) { return counters.rate(current, previous); };
+    rates.rx_bytes = rate(now.rx_bytes, before->rx_bytes);
+    rates.rx_packets = rate(now.rx_packets, before->rx_packets);
+    rates.rx_errors = rate(now.rx_errors, before->rx_errors);
+    rates.rx_drops = rate(now.rx_drops, before->rx_drops);
+    rates.rx_fifo = rate(now.rx_fifo, before->rx_fifo);
+    rates.tx_bytes = rate(now.tx_bytes, before->tx_bytes);
+    rates.tx_packets = rate(now.tx_packets, before->tx_packets);
+    rates.tx_errors = rate(now.tx_errors, before->tx_errors);
+    rates.tx_drops = rate(now.tx_drops, before->tx_drops);
+    rates.tx_fifo = rate(now.tx_fifo, before->tx_fifo);
+
+    rates.valid = counters.valid;
+    if (!rates.valid) {
+        InterfaceRates reset{};
+        memcpy(reset.name, now.name, sizeof(reset.name));
+        rates = reset;
+    }
+}
+
+// =============================================================================
+// SAMPLING
+// =============================================================================
+
+/**
+ * Everything collected in one tick
+ * Filled by the sampler thread and handed to the UI as a whole, so the UI
+ * never sees a half-updated set of metrics.
+ */
+struct Snapshot {
+    bool valid = false;  // False until the first tick has been collected
+    double timestamp = 0.0;  // CLOCK_MONOTONIC time of collection, in seconds
+    double wall_time = 0.0;  // CLOCK_REALTIME time of collection, in Unix seconds
+    double interval = 0.0;   // Measured seconds since the previous collection
+    CpuUsage cpu;
+    SchedulerActivity scheduler;  // Load averages, task counts and scheduler rates
+    double ram_usage = -1.0;   // MemTotal - MemAvailable, as a percentage
+    MemoryInfo memory;         // All zero if /proc/meminfo cannot be read
+    Pressure pressure[PRESSURE_RESOURCES];  // Indexed by PressureResource
+    bool stall_event = false;  // Collected early because a pressure trigger fired
+    VmstatRates vmstat;        // Paging and reclaim activity
+    double disk_usage = -1.0;  // Root filesystem
+    std::vector<FilesystemUsage> filesystems;  // Every real mount, root included
+    double uptime = 0.0;
+    double temperature = -1.0;
+    std::string hostname;
+    std::string username;
+    ull rx_rate = 0;  // Bytes per second received, excluding loopback
+    ull tx_rate = 0;  // Bytes per second sent, excluding loopback
+    std::vector<InterfaceRates> interfaces;  // Every interface, loopback included
+    std::vector<DiskIo> disk_io;  // Active whole disks, in /proc/diskstats order
+    InterruptRates interrupts;    // Hardware interrupts per CPU, from /proc/interrupts
+    InterruptRates softirqs;      // Softirqs per CPU, from /proc/softirqs
+};
+
+/**
+ * Lock-free single-producer/single-consumer slot for the latest snapshot
+ * Implemented as a triple buffer: the producer fills its private back
+ * buffer and atomically swaps it into the shared middle slot, and the
+ * consumer swaps the middle slot with its private front buffer whenever it
+ * holds something newer. Neither side ever waits for the other, and since
+ * the three buffers are recycled their allocations are reused.
+ */
+template <typename T>
+struct SnapshotSlot {
+    static constexpr unsigned INDEX_MASK = 0x3;
+    static constexpr unsigned FRESH = 0x4;  // Middle slot not yet consumed
+
+    T buffers[3];
+    alignas(64) std::atomic<unsigned> middle{1};
+    alignas(64) unsigned back_index = 0;   // Owned by the producer
+    alignas(64) unsigned front_index = 2;  // Owned by the consumer
+
+    /** Producer: buffer to fill for the next publish() */
+    T &back() { return buffers[back_index]; }
+
+    /** Producer: makes the back buffer the latest snapshot */
+    void publish() {
+        unsigned previous = middle.exchange(back_index | FRESH, std::memory_order_acq_rel);
+        back_index = previous & INDEX_MASK;
+    }
+
+    /**
+     * Consumer: picks up the latest snapshot, if one was published since the
+     * last call
+     * @return true if front() changed
+     */
+    bool consume() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        unsigned previous = middle.exchange(front_index, std::memory_order_acq_rel);
+        front_index = previous & INDEX_MASK;
+        return true;
+    }
+
+    /** Consumer: latest snapshot picked up by consume() */
+    const T &front() const { return buffers[front_index]; }
+};
+
+/**
+ * Reads the monotonic clock
+ * @return Seconds since an arbitrary fixed point, unaffected by clock changes
+ */
+double monotonic_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * Reads the wall clock
+ * @return Seconds since the Unix epoch
+ */
+double wall_clock_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * Periodic CLOCK_MONOTONIC timer with absolute deadlines
+ * The kernel advances the deadline by exactly one period on each expiry, so
+ * the time spent collecting never shifts the schedule. Missed deadlines
+ * (e.g. after a stall) are coalesced rather than replayed.
+ */
+struct TickTimer {
+    int fd = -1;
+
+    TickTimer() {
+        fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "timerfd_create");
+        }
+    }
+
+    TickTimer(const TickTimer &) = delete;
+    TickTimer &operator=(const TickTimer &) = delete;
+
+    ~TickTimer() { close(fd); }
+
+    /**
+     * Starts ticking
+     * @param first_delay Time until the first expiry
+     * @param period Time between subsequent expiries
+     */
+    void arm(std::chrono::nanoseconds first_delay, std::chrono::nanoseconds period) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        long long first = (long long)now.tv_sec * 1000000000LL + now.tv_nsec + first_delay.count();
+        struct itimerspec spec = {};
+        spec.it_value.tv_sec = first / 1000000000LL;
+        spec.it_value.tv_nsec = first % 1000000000LL;
+        spec.it_interval.tv_sec = period.count() / 1000000000LL;
+        spec.it_interval.tv_nsec = period.count() % 1000000000LL;
+        timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+
+    /**
+     * Clears pending expiries after poll() reported the timer readable
+     * @return Number of deadlines passed since the last call
+     */
+    ull acknowledge() {
+        uint64_t expirations = 0;
+        if (::read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) return 0;
+        return expirations;
+    }
+};
+
+/**
+ * Collector state carried from one tick to the next
+ */
+struct Sampler {
+    CpuSampler cpu_sampler;
+    HostFacts host_facts;
+    ThermalSensor thermal_sensor;
+    PressureMonitor pressure_monitor;
+    VmstatSampler vmstat_sampler;
+    DiskIoSampler disk_io_sampler;
+    InterruptSampler interrupt_sampler{"/proc/interrupts"};
+    InterruptSampler softirq_sampler{"/proc/softirqs"};
+    FilesystemMonitor filesystem_monitor;
+    NetlinkLinkStats netlink;
+    std::vector<InterfaceStats> previous_network_stats, current_network_stats;
+    double previous_time = 0.0;  // Monotonic time of the previous collection
+
+    /**
+     * Takes the first readings that later deltas are computed against
+     */
+    void prime() {
+        CpuUsage unused;
+        SchedulerActivity unused_scheduler;
+        cpu_sampler.sample(0.0, unused, unused_scheduler);
+        Pressure unused_pressure[PRESSURE_RESOURCES];
+        bool unused_event;
+        pressure_monitor.sample(0.0, unused_pressure, unused_event);
+        VmstatRates unused_vmstat;
+        vmstat_sampler.sample(0.0, unused_vmstat);
+        std::vector<DiskIo> unused_disks;
+        disk_io_sampler.sample(0.0, unused_disks);
+        InterruptRates unused_interrupts;
+        interrupt_sampler.sample(0.0, unused_interrupts);
+        softirq_sampler.sample(0.0, unused_interrupts);
+        read_interface_counters(netlink, previous_network_stats);
+        std::vector<FilesystemUsage> unused_filesystems;  // Starts the first statvfs() batch
+        filesystem_monitor.sample(unused_filesystems);
+        previous_time = monotonic_seconds();
+    }
+
+    /**
+     * Collects all metrics into snapshot
+     * @param snapshot Output, overwritten field by field to reuse its buffers
+     */
+    void collect(Snapshot &snapshot) {
+        // Rates are per measured second, not per nominal tick
+        snapshot.timestamp = monotonic_seconds();
+        snapshot.wall_time = wall_clock_seconds();
+        snapshot.interval = snapshot.timestamp - previous_time;
+        previous_time = snapshot.timestamp;
+
+        cpu_sampler.sample(snapshot.interval, snapshot.cpu, snapshot.scheduler);
+        get_load_average(snapshot.scheduler.load);
+        get_memory_info(snapshot.memory);
+        snapshot.ram_usage = snapshot.memory.used_percent();
+        pressure_monitor.sample(snapshot.interval, snapshot.pressure, snapshot.stall_event);
+        vmstat_sampler.sample(snapshot.interval, snapshot.vmstat);
+        snapshot.uptime = get_uptime_seconds();
+        disk_io_sampler.sample(snapshot.interval, snapshot.disk_io);
+        interrupt_sampler.sample(snapshot.interval, snapshot.interrupts);
+        softirq_sampler.sample(snapshot.interval, snapshot.softirqs);
+        snapshot.temperature = thermal_sensor.read(snapshot.timestamp);
+
+        host_facts.refresh(snapshot.timestamp);
+        snapshot.hostname = host_facts.hostname;
+        snapshot.username = host_facts.username;
+
+        // Calculate network transfer rates per interface
+        read_interface_counters(netlink, current_network_stats);
+        snapshot.interfaces.resize(current_network_stats.size());
+        double total_rx_rate = 0.0, total_tx_rate = 0.0;
+
+        for (size_t i = 0; i < current_network_stats.size(); ++i) {
+            const InterfaceStats &interface = current_network_stats[i];
+
+            const InterfaceStats *previous =
+                find_previous_interface(previous_network_stats, interface, i);
+            InterfaceRates &rates = snapshot.interfaces[i];
+            compute_interface_rates(interface, previous, snapshot.interval, rates);
+
+            // Totals leave out the loopback interface and interfaces
+            // without a rate for this interval
+            if (rates.valid && strcmp(interface.name, "lo") != 0) {
+                total_rx_rate += rates.rx_bytes;
+                total_tx_rate += rates.tx_bytes;
+            }
+        }
+
+        previous_network_stats.swap(current_network_stats);
+        snapshot.rx_rate = (ull)total_rx_rate;
+        snapshot.tx_rate = (ull)total_tx_rate;
+
+        filesystem_monitor.sample(snapshot.filesystems);
+        snapshot.disk_usage = -1.0;
+        for (const FilesystemUsage &filesystem : snapshot.filesystems) {
+            if (filesystem.mount_point == "/") snapshot.disk_usage = filesystem.usage;
+        }
+        snapshot.valid = true;
+    }
+};
+
+/**
+ * Decides how long the sampler waits before the next tick
+ * In fixed mode the period never changes. In adaptive mode the sampler
+ * drops to the fastest period as soon as CPU usage moves by more than
+ * cpu_threshold points between two ticks, and otherwise multiplies the
+ * period by 1.5 per tick until it reaches the slowest period. On short
+ * periods with few CPUs a single jiffy is worth several points, so the
+ * threshold is raised to twice that resolution to keep counter
+ * quantization from looking like activity.
+ */
+struct IntervalPolicy {
+    std::chrono::milliseconds fastest{1000};
+    std::chrono::milliseconds slowest{1000};
+    bool adaptive = false;
+    double cpu_threshold = 10.0;  // Percentage points between two ticks
+    double previous_cpu = -1.0;
+    double ticks_per_second = (double)sysconf(_SC_CLK_TCK);  // Jiffies per second in /proc/stat
+
+    /**
+     * Chooses the period after a tick
+     * @param snapshot The snapshot just collected
+     * @param current The period that produced it
+     * @return Period until the following tick
+     */
+    std::chrono::milliseconds next(const Snapshot &snapshot, std::chrono::milliseconds current) {
+        if (!adaptive) return current;
+
+        // Points of aggregate CPU usage that one jiffy amounts to this tick
+        double cpus = (double)std::max<size_t>(snapshot.cpu.per_core.size(), 1);
+        double jiffy_points = 100.0 / std::max(ticks_per_second * snapshot.interval * cpus, 1.0);
+        double threshold = std::max(cpu_threshold, 2.0 * jiffy_points);
+
+        double cpu = snapshot.cpu.total;
+        bool changing = previous_cpu >= 0.0 && cpu >= 0.0 &&
+                        std::fabs(cpu - previous_cpu) > threshold;
+        previous_cpu = cpu;
+
+        if (changing) return fastest;
+        return std::min(current + current / 2, slowest);
+    }
+};
+
+/**
+ * Creates a non-blocking eventfd used to wake another thread
+ * @return File descriptor; throws std::system_error on failure
+ */
+int create_eventfd() {
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "eventfd");
+    }
+    return fd;
+}
+
+/** Makes an eventfd readable */
+void notify_eventfd(int fd) {
+    uint64_t one = 1;
+    ssize_t written = write(fd, &one, sizeof(one));
+    (void)written; // Only fails for an invalid descriptor or a saturated counter
+}
+
+/** Resets an eventfd after poll() reported it readable */
+void drain_eventfd(int fd) {
+    uint64_t count;
+    ssize_t bytes = read(fd, &count, sizeof(count));
+    (void)bytes; // EAGAIN just means it was already drained
+}
+
+/**
+ * Runs the collectors on a dedicated thread
+ * A slow collector (e.g. statvfs() on a hung NFS mount) only delays the
+ * next snapshot; the UI keeps handling input and redrawing meanwhile. The
+ * thread sleeps in poll() on its tick timer and a stop eventfd, and signals
+ * ready_fd after every publish so the UI can sleep in poll() as well. A
+ * pressure stall trigger ends the wait early, so stalls show up as they
+ * happen.
+ */
+struct SamplerThread {
+    Sampler sampler;
+    SnapshotSlot<Snapshot> slot;
+    IntervalPolicy policy;  // Configure before start()
+
+    // Called on the sampler thread with every snapshot before it is
+    // published, e.g. to pre-render exporter output; register before start()
+    std::vector<std::function<void(const Snapshot &)>> observers;
+
+    TickTimer timer;
+    int stop_fd = create_eventfd();   // Written by stop()
+    int ready_fd = create_eventfd();  // Written after each publish()
+    std::thread thread;
+
+    SamplerThread() = default;
+    SamplerThread(const SamplerThread &) = delete;
+    SamplerThread &operator=(const SamplerThread &) = delete;
+
+    ~SamplerThread() {
+        stop();
+        close(stop_fd);
+        close(ready_fd);
+    }
+
+    void start() {
+        thread = std::thread([this] { run(); });
+    }
+
+    /** Asks the thread to finish and waits for it */
+    void stop() {
+        notify_eventfd(stop_fd);
+        if (thread.joinable()) thread.join();
+    }
+
+    /**
+     * Sleeps until the next tick deadline, a pressure stall, or until stop()
+     * is called
+     * @return false if the thread should exit
+     */
+    bool wait_for_tick() {
+        // A negative descriptor is ignored by poll()
+        constexpr int WATCHES = 4;
+        struct pollfd fds[WATCHES + PRESSURE_RESOURCES] = {
+            {timer.fd, POLLIN, 0},
+            {stop_fd, POLLIN, 0},
+            {sampler.host_facts.hostname_watch_fd, POLLPRI, 0},
+            {sampler.filesystem_monitor.watch_fd(), POLLPRI, 0},
+        };
+        PressureMonitor &pressure = sampler.pressure_monitor;
+        for (int resource = 0; resource < PRESSURE_RESOURCES; ++resource) {
+            fds[WATCHES + resource] = {pressure.trigger_fds[resource], POLLPRI, 0};
+        }
+
+        while (true) {
+            if (poll(fds, WATCHES + PRESSURE_RESOURCES, -1) < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if (fds[1].revents) return false;
+            if (fds[2].revents) sampler.host_facts.on_hostname_changed();
+            if (fds[3].revents) sampler.filesystem_monitor.on_mounts_changed();
+            for (int resource = 0; resource < PRESSURE_RESOURCES; ++resource) {
+                struct pollfd &trigger = fds[WATCHES + resource];
+                if (!trigger.revents) continue;
+                pressure.on_trigger(resource, trigger.revents);
+                trigger.fd = pressure.trigger_fds[resource];
+            }
+            bool tick = fds[0].revents && timer.acknowledge() > 0;
+            if (tick || pressure.stalled) return true;
+        }
+    }
+
+    void run() {
+        // Get initial readings for rate calculation; the first tick follows
+        // after at most half a second, then ticks run on a fixed schedule
+        // until the policy picks a different period
+        std::chrono::milliseconds period = policy.fastest;
+        sampler.prime();
+        timer.arm(std::min(period, std::chrono::milliseconds(500)), period);
+
+        while (wait_for_tick()) {
+            Snapshot &snapshot = slot.back();
+            sampler.collect(snapshot);
+
+            std::chrono::milliseconds next_period = policy.next(snapshot, period);
+            for (const auto &observer : observers) {
+                observer(snapshot);
+            }
+            slot.publish();
+            notify_eventfd(ready_fd);
+
+            if (next_period != period) {
+                period = next_period;
+                timer.arm(period, period);
+            }
+        }
+    }
+};
+
+// =============================================================================
+// HISTORY
+// =============================================================================
+
+/**
+ * Fixed-capacity ring of the recent history of one metric, one slot per
+ * fixed span of monotonic time
+ * Slots cover equal time whatever the sampling interval, so a sparkline
+ * spans the same minutes at 100ms, at 5s or in adaptive mode, and early
+ * samples taken on a pressure trigger do not stretch the x-axis. Several
+ * samples within one slot keep their peak; a sample after a longer
+ * interval fills every slot it covers, since its value (usually a rate) is
+ * the measurement for that whole interval. Storage is allocated once up
+ * front and push() overwrites the oldest slot, so recording never
+ * allocates. Values are stored as float to keep a whole history within a
+ * few cache lines' worth of pages.
+ */
+struct MetricHistory {
+    std::vector<float> samples;
+    double slot_seconds;         // Monotonic time covered by one slot
+    size_t next = 0;             // Slot the next new slot is written to
+    size_t count = 0;            // Number of valid slots
+    long long newest_slot = -1;  // Time of the newest slot, in slot_seconds since boot
+
+    MetricHistory(size_t capacity, double seconds_per_slot)
+        : samples(capacity), slot_seconds(seconds_per_slot) {}
+
+    /**
+     * Records a sample; negative values mark "not available"
+     * @param value Sample value
+     * @param time CLOCK_MONOTONIC time of the sample, in seconds
+     */
+    void push(double value, double time) {
+        const long long slot = (long long)(time / slot_seconds);
+        if (count > 0 && slot <= newest_slot) {
+            // Same slot as the previous sample: keep the peak, and a known
+            // value over an unknown one
+            float &newest = samples[(next + samples.size() - 1) % samples.size()];
+            newest = newest < 0.0f ? (float)value : std::max(newest, (float)value);
+            return;
+        }
+
+        long long passed = count > 0 ? slot - newest_slot : 1;
+        passed = std::min(passed, (long long)samples.size());
+        for (long long i = 0; i < passed; ++i) {
+            samples[next] = (float)value;
+            next = (next + 1) % samples.size();
+            if (count < samples.size()) count++;
+        }
+        newest_slot = slot;
+    }
+
+    /**
+     * Accesses a retained slot
+     * @param index 0 for the oldest retained slot, count - 1 for the newest
+     */
+    float at(size_t index) const {
+        return samples[(next + samples.size() - count + index) % samples.size()];
+    }
+
+    /** Largest retained value, or 0.0 if there are none */
+    float max() const {
+        float largest = 0.0f;
+        for (size_t i = 0; i < count; ++i) largest = std::max(largest, samples[i]);
+        return largest;
+    }
+};
+
+/**
+ * Recent history of every metric drawn with a sparkline
+ */
+struct History {
+    static constexpr size_t CAPACITY = 300;        // Slots: five minutes of one second each
+    static constexpr double SLOT_SECONDS = 1.0;
+
+    MetricHistory cpu{CAPACITY, SLOT_SECONDS};
+    MetricHistory ram{CAPACITY, SLOT_SECONDS};
+    MetricHistory disk{CAPACITY, SLOT_SECONDS};
+    MetricHistory rx{CAPACITY, SLOT_SECONDS};
+    MetricHistory tx{CAPACITY, SLOT_SECONDS};
+    MetricHistory temperature{CAPACITY, SLOT_SECONDS};
+
+    /** Records one sample of each metric at the snapshot's time */
+    void record(const Snapshot &snapshot) {
+        const double time = snapshot.timestamp;
+        cpu.push(snapshot.cpu.total, time);
+        ram.push(snapshot.ram_usage, time);
+        disk.push(snapshot.disk_usage, time);
+        rx.push((double)snapshot.rx_rate, time);
+        tx.push((double)snapshot.tx_rate, time);
+        temperature.push(snapshot.temperature, time);
+    }
+};
+
+// =============================================================================
+// UTILITY FUNCTIONS
+// =============================================================================
+
+/**
+ * Converts bytes to human-readable format (B, KB, MB, GB, TB)
+ * @param bytes Number of bytes to convert
+ * @return Formatted string with appropriate unit
+ */
+std::string format_bytes(ull bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = (double)bytes;
+    int unit_index = 0;
+
+    // Convert to appropriate unit
+    while (value >= 1024.0 && unit_index < 4) {
+        value /= 1024.0;
+        unit_index++;
+    }
+
+    std::ostringstream formatted;
+    formatted << std::fixed << std::setprecision(2) << value << " " << units[unit_index];
+    return formatted.str();
+}
+
+/**
+ * Formats a size in KiB compactly, e.g. "588K", "2.5G", "916M"
+ * @param kib Size in KiB
+ * @param out Output buffer
+ * @param size Size of out
+ */
+void format_kib_short(ull kib, char *out, size_t size) {
+    const char units[] = {'K', 'M', 'G', 'T', 'P'};
+    double value = (double)kib;
+    int unit_index = 0;
+    while (value >= 1024.0 && unit_index < 4) {
+        value /= 1024.0;
+        unit_index++;
+    }
+    snprintf(out, size, value < 10.0 && unit_index > 0 ? "%.1f%c" : "%.0f%c", value, units[unit_index]);
+}
+
+/**
+ * Formats an event count or rate compactly, e.g. "950", "12.3k", "4.1M"
+ * @param value Count, at least 0
+ * @param out Output buffer
+ * @param size Size of out
+ */
+void format_count_short(double value, char *out, size_t size) {
+    if (value >= 1e6) {
+        snprintf(out, size, "%.1fM", value / 1e6);
+    } else if (value >= 1e4) {
+        snprintf(out, size, "%.0fk", value / 1e3);
+    } else if (value >= 1e3) {
+        snprintf(out, size, "%.1fk", value / 1e3);
+    } else {
+        snprintf(out, size, "%.0f", value);
+    }
+}
+
+/**
+ * Formats uptime seconds into human-readable format
+ * @param seconds Uptime in seconds
+ * @return Formatted string like "2d 5h 30m"
+ */
+std::string format_uptime(double seconds) {
+    int total_seconds = (int)seconds;
+    int days = total_seconds / 86400;
+    int hours = (total_seconds % 86400) / 3600;
+    int minutes = (total_seconds % 3600) / 60;
+
+    std::ostringstream formatted;
+    if (days > 0) {
+        formatted << days << "d " << hours << "h " << minutes << "m";
+    } else if (hours > 0) {
+        formatted << hours << "h " << minutes << "m";
+    } else {
+        formatted << minutes << "m " << (total_seconds % 60) << "s";
+    }
+    
+    return formatted.str();
+}
+
+/**
+ * Growable output buffer with hand-written number formatting
+ * Numbers are formatted without iostreams or printf: this is independent of
+ * LC_NUMERIC and avoids format-string parsing on every value. The buffer
+ * is reused between documents and only grows when one outgrows it.
+ */
+struct OutputBuffer {
+    std::vector<char> buffer;
+    size_t length = 0;
+
+    explicit OutputBuffer(size_t capacity = 16384) : buffer(capacity) {}
+
+    void clear() { length = 0; }
+    const char *data() const { return buffer.data(); }
+    size_t size() const { return length; }
+
+    /** Makes room for at least extra more bytes */
+    void reserve(size_t extra) {
+        if (length + extra > buffer.size()) {
+            buffer.resize(std::max(buffer.size() * 2, length + extra));
+        }
+    }
+
+    void put(char c) {
+        reserve(1);
+        buffer[length++] = c;
+    }
+
+    void put(const char *text, size_t size) {
+        reserve(size);
+        memcpy(buffer.data() + length, text, size);
+        length += size;
+    }
+
+    /** Writes an unsigned integer in decimal */
+    void number(ull value) {
+        char digits[20];
+        int count = 0;
+        do {
+            digits[count++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value);
+
+        reserve(count);
+        while (count) buffer[length++] = digits[--count];
+    }
+
+    /**
+     * Writes a fixed-point number, or NaN if it is not finite
+     * Magnitudes of 1e19 and above are written in exponent notation.
+     * @param value Number to write
+     * @param decimals Digits after the decimal point (0-6)
+     */
+    void number(double value, int decimals) {
+        static const ull powers[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+        if (!std::isfinite(value)) {
+            put("NaN", 3);
+            return;
+        }
+        if (value < 0) {
+            put('-');
+            value = -value;
+        }
+
+        // Beyond the range of an unsigned 64-bit integer, where the cast
+        // below would be undefined: six significant decimals and an exponent
+        if (value >= 1e19) {
+            int exponent = (int)std::floor(std::log10(value));
+            ull mantissa = (ull)std::llround(value / std::pow(10.0, exponent) * 1e6);
+            if (mantissa >= 10000000) {  // Rounded up to 10.000000
+                mantissa /= 10;
+                exponent++;
+            }
+            number(mantissa / 1000000);
+            put('.');
+            for (ull divisor = 100000; divisor > 0; divisor /= 10) {
+                put((char)('0' + mantissa / divisor % 10));
+            }
+            put('e');
+            number((ull)exponent);
+            return;
+        }
+
+        // Values too large for the scaled integer are written without fraction
+        const ull scale = powers[decimals];
+        if (value >= 1e18 / scale) {
+            number((ull)value);
+            return;
+        }
+
+        ull scaled = (ull)std::llround(value * scale);
+        number(scaled / scale);
+        if (decimals > 0) {
+            put('.');
+            ull fraction = scaled % scale;
+            for (ull divisor = scale / 10; divisor > 0; divisor /= 10) {
+                put((char)('0' + fraction / divisor % 10));
+            }
+        }
+    }
+};
+
+// =============================================================================
+// UI DRAWING FUNCTIONS
+// =============================================================================
+
+/**
+ * Color pairs used for load-dependent highlighting
+ */
+enum ColorPair {
+    COLOR_PAIR_LOW = 1,
+    COLOR_PAIR_MEDIUM,
+    COLOR_PAIR_HIGH,
+    COLOR_PAIR_USER,
+    COLOR_PAIR_NICE,
+    COLOR_PAIR_SYSTEM,
+    COLOR_PAIR_IRQ,
+    COLOR_PAIR_SOFTIRQ,
+    COLOR_PAIR_STEAL,
+    COLOR_PAIR_GUEST,
+    COLOR_PAIR_ANON,
+    COLOR_PAIR_KERNEL,
+    COLOR_PAIR_SHMEM,
+    COLOR_PAIR_CACHE,
+};
+
+/**
+ * Initializes the color pairs, if the terminal supports colors
+ */
+void init_color_pairs() {
+    if (!has_colors()) return;
+
+    start_color();
+    use_default_colors();
+    init_pair(COLOR_PAIR_LOW, COLOR_GREEN, -1);
+    init_pair(COLOR_PAIR_MEDIUM, COLOR_YELLOW, -1);
+    init_pair(COLOR_PAIR_HIGH, COLOR_RED, -1);
+
+    // CPU time states in the stacked CPU bar
+    init_pair(COLOR_PAIR_USER, COLOR_GREEN, -1);
+    init_pair(COLOR_PAIR_NICE, COLOR_BLUE, -1);
+    init_pair(COLOR_PAIR_SYSTEM, COLOR_RED, -1);
+    init_pair(COLOR_PAIR_IRQ, COLOR_MAGENTA, -1);
+    init_pair(COLOR_PAIR_SOFTIRQ, COLOR_YELLOW, -1);
+    init_pair(COLOR_PAIR_STEAL, COLOR_CYAN, -1);
+    init_pair(COLOR_PAIR_GUEST, COLOR_WHITE, -1);
+
+    // Kinds of memory in the stacked RAM bar
+    init_pair(COLOR_PAIR_ANON, COLOR_GREEN, -1);
+    init_pair(COLOR_PAIR_KERNEL, COLOR_RED, -1);
+    init_pair(COLOR_PAIR_SHMEM, COLOR_MAGENTA, -1);
+    init_pair(COLOR_PAIR_CACHE, COLOR_YELLOW, -1);
+}
+
+/**
+ * Picks the color pair for a percentage value
+ * @param percentage Value in the range 0.0-100.0
+ * @return Color pair number
+ */
+int color_pair_for(double percentage) {
+    if (percentage >= 85.0) return COLOR_PAIR_HIGH;
+    if (percentage >= 50.0) return COLOR_PAIR_MEDIUM;
+    return COLOR_PAIR_LOW;
+}
+
+/**
+ * Draws a box using Unicode box-drawing characters
+ * @param y Top-left Y coordinate
+ * @param x Top-left X coordinate  
+ * @param height Box height
+ * @param width Box width
+ */
+void draw_box(int y, int x, int height, int width) {
+    // Draw corners
+    mvprintw(y, x, "┌");                           // Top-left
+    mvprintw(y, x + width - 1, "┐");               // Top-right
+    mvprintw(y + height - 1, x, "└");              // Bottom-left
+    mvprintw(y + height - 1, x + width - 1, "┘");  // Bottom-right
+
+    // Draw horizontal edges
+    for (int i = 1; i < width - 1; i++) {
+        mvprintw(y, x + i, "─");                   // Top edge
+        mvprintw(y + height - 1, x + i, "─");      // Bottom edge
+    }
+
+    // Draw vertical edges
+    for (int i = 1; i < height - 1; i++) {
+        mvprintw(y + i, x, "│");                   // Left edge
+        mvprintw(y + i, x + width - 1, "│");       // Right edge
+    }
+}
+
+/**
+ * One colored section of a stacked progress bar
+ */
+struct BarSegment {
+    double percentage;          // Share of the bar (0.0-100.0)
+    int color_pair;             // Color pair number, or 0 for the default colors
+    const char *block = "█";  // Character the segment is drawn with
+};
+
+/**
+ * Draws a stacked progress bar with one colored run of blocks per segment
+ * Segment edges are rounded on the running total so that the drawn blocks
+ * always add up to the combined percentage.
+ * @param row Y position for the bar
+ * @param col X position for the bar
+ * @param segments Segments to draw, left to right
+ * @param count Number of segments
+ * @param label Text label for the bar
+ * @param value Percentage printed after the bar, or -1.0 for the segments' total
+ */
+void draw_progress_bar(int row, int col, const BarSegment *segments, size_t count, const char* label,
+                       double value = -1.0) {
+    const int bar_width = 35;  // Width of the progress bar
+    const bool colors = has_colors();
+
+    // Print label and opening bracket
+    mvprintw(row, col, "%s │", label);
+
+    // Draw each segment up to its cumulative edge
+    double cumulative = 0.0;
+    int drawn_blocks = 0;
+    for (size_t s = 0; s < count; ++s) {
+        cumulative = std::min(cumulative + std::max(segments[s].percentage, 0.0), 100.0);
+        int edge = (int)(cumulative / 100.0 * bar_width);
+
+        if (colors && segments[s].color_pair) attron(COLOR_PAIR(segments[s].color_pair));
+        for (; drawn_blocks < edge; drawn_blocks++) {
+            addstr(segments[s].block);
+        }
+        if (colors && segments[s].color_pair) attroff(COLOR_PAIR(segments[s].color_pair));
+    }
+    for (; drawn_blocks < bar_width; drawn_blocks++) {
+        addstr(" ");  // Empty space
+    }
+
+    // Print closing bracket and percentage
+    printw("│ %6.2f%%", value >= 0.0 ? value : cumulative);
+}
+
+/**
+ * Draws a modern progress bar with Unicode block characters
+ * @param row Y position for the bar
+ * @param col X position for the bar
+ * @param percentage Value to display (0.0-100.0)
+ * @param label Text label for the bar
+ */
+void draw_progress_bar(int row, int col, double percentage, const char* label) {
+    const BarSegment segment = {percentage, 0};
+    draw_progress_bar(row, col, &segment, 1, label);
+}
+
+/**
+ * One entry of the legend line below a stacked bar
+ */
+struct LegendEntry {
+    const char *name;  // Drawn in the segment's color
+    char value[16];    // Drawn after the name in the default color
+    int color_pair;    // Color pair number, or 0 for the default colors
+};
+
+/**
+ * Draws legend entries on one line, leaving out those that do not fit
+ * @param row Y position
+ * @param col X position of the first entry
+ * @param entries Entries to draw, left to right
+ * @param count Number of entries
+ * @param width Columns available
+ */
+void draw_legend(int row, int col, const LegendEntry *entries, size_t count, int width = 66) {
+    const bool colors = has_colors();
+    const int legend_end = col + width;
+    move(row, col);
+    for (size_t i = 0; i < count; ++i) {
+        const LegendEntry &entry = entries[i];
+        if (getcurx(stdscr) + (int)(strlen(entry.name) + strlen(entry.value)) >= legend_end) break;
+
+        if (getcurx(stdscr) > col) addstr(" ");
+        if (colors && entry.color_pair) attron(COLOR_PAIR(entry.color_pair));
+        addstr(entry.name);
+        if (colors && entry.color_pair) attroff(COLOR_PAIR(entry.color_pair));
+        addstr(entry.value);
+    }
+}
+
+/**
+ * Draws the CPU bar stacked by time state, with a legend line below it
+ * @param row Y position for the bar
+ * @param col X position for the bar
+ * @param breakdown Aggregate CPU time split by state
+ * @return Number of rows drawn
+ */
+int draw_cpu_breakdown(int row, int col, const CpuBreakdown &breakdown) {
+    const BarSegment segments[] = {
+        {breakdown.user, COLOR_PAIR_USER},
+        {breakdown.nice, COLOR_PAIR_NICE},
+        {breakdown.system, COLOR_PAIR_SYSTEM},
+        {breakdown.irq, COLOR_PAIR_IRQ},
+        {breakdown.softirq, COLOR_PAIR_SOFTIRQ},
+        {breakdown.steal, COLOR_PAIR_STEAL},
+        {breakdown.guest, COLOR_PAIR_GUEST},
+    };
+    draw_progress_bar(row, col, segments, sizeof(segments) / sizeof(segments[0]), "CPU  ");
+
+    // Legend: each state's label in its bar color, followed by its share
+    LegendEntry legend[] = {
+        {"usr", "", COLOR_PAIR_USER},
+        {"nic", "", COLOR_PAIR_NICE},
+        {"sys", "", COLOR_PAIR_SYSTEM},
+        {"irq", "", COLOR_PAIR_IRQ},
+        {"sirq", "", COLOR_PAIR_SOFTIRQ},
+        {"st", "", COLOR_PAIR_STEAL},
+        {"gst", "", COLOR_PAIR_GUEST},
+        {"wa", "", 0},
+    };
+    const double shares[] = {
+        breakdown.user, breakdown.nice, breakdown.system, breakdown.irq,
+        breakdown.softirq, breakdown.steal, breakdown.guest, breakdown.iowait,
+    };
+    for (size_t i = 0; i < std::size(legend); ++i) {
+        snprintf(legend[i].value, sizeof(legend[i].value), shares[i] >= 10.0 ? " %.0f" : " %.1f",
+                 shares[i]);
+    }
+    draw_legend(row + 1, col, legend, std::size(legend));
+    return 2;
+}
+
+/**
+ * Draws the RAM bar stacked by kind of memory, with a legend line below it
+ * The solid part ends at the percentage printed, MemTotal - MemAvailable:
+ * anonymous, kernel and shared memory are scaled to fill it, since the
+ * kernel's availability estimate keeps part of the cache. The rest of the
+ * memory that is not free, i.e. cache the kernel counts as available, is
+ * drawn shaded after it.
+ * @param row Y position for the bar
+ * @param col X position for the bar
+ * @param memory Figures from /proc/meminfo
+ * @return Number of rows drawn
+ */
+int draw_memory_breakdown(int row, int col, const MemoryInfo &memory) {
+    const double total = (double)std::max(memory.total, 1ULL);
+    const double used = memory.used_percent();
+    const double in_use = (double)(memory.total - std::min(memory.free, memory.total)) * 100.0 / total;
+    const double stacked = (double)(memory.anon + memory.kernel() + memory.shmem);
+    const double scale = stacked > 0.0 ? used / stacked : 0.0;
+    const BarSegment segments[] = {
+        {(double)memory.anon * scale, COLOR_PAIR_ANON},
+        {(double)memory.kernel() * scale, COLOR_PAIR_KERNEL},
+        {(double)memory.shmem * scale, COLOR_PAIR_SHMEM},
+        {std::max(in_use - used, 0.0), COLOR_PAIR_CACHE, "░"},
+    };
+    draw_progress_bar(row, col, segments, std::size(segments), "RAM  ", used);
+
+    // Legend: sizes of the stacked kinds, then swap and writeback activity
+    LegendEntry legend[] = {
+        {"anon", "", COLOR_PAIR_ANON},
+        {"kern", "", COLOR_PAIR_KERNEL},
+        {"shm", "", COLOR_PAIR_SHMEM},
+        {"cache", "", COLOR_PAIR_CACHE},
+        {"swap", "", 0},
+        {"dirty", "", 0},
+        {"wb", "", 0},
+    };
+    const ull sizes[] = {
+        memory.anon, memory.kernel(), memory.shmem, memory.reclaimable_cache(),
+        memory.swap_total - std::min(memory.swap_free, memory.swap_total),
+        memory.dirty, memory.writeback,
+    };
+    for (size_t i = 0; i < std::size(legend); ++i) {
+        legend[i].value[0] = ' ';
+        format_kib_short(sizes[i], legend[i].value + 1, sizeof(legend[i].value) - 1);
+    }
+    draw_legend(row + 1, col, legend, std::size(legend));
+    return 2;
+}
+
+/**
+ * Number of rows draw_heat_strip() needs for a given number of cells
+ * @param cells Number of values to display
+ * @param width Cells per row
+ */
+int heat_strip_rows(size_t cells, int width) {
+    return (int)((cells + width - 1) / width);
+}
+
+/**
+ * Draws one cell per value (e.g. per CPU core), with the block height and
+ * color showing its level, wrapping to further rows after width cells
+ * @param row Y position of the first strip row
+ * @param col X position for the strip label
+ * @param values Values to display (0.0-100.0); negative values are unknown
+ *               and left blank
+ * @param count Number of values
+ * @param label Text label for the strip
+ * @param width Cells per row
+ * @return Number of rows drawn
+ */
+int draw_heat_strip(int row, int col, const double *values, size_t count, const char *label, int width) {
+    static const char *const levels[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    const bool colors = has_colors();
+    const int label_width = (int)strlen(label);
+
+    int rows = heat_strip_rows(count, width);
+    for (int r = 0; r < rows; ++r) {
+        mvprintw(row + r, col, "%-*s │", label_width, r == 0 ? label : "");
+        for (int i = r * width; i < (r + 1) * width && i < (int)count; ++i) {
+            if (values[i] < 0.0) {
+                addstr(" ");
+                continue;
+            }
+            double value = std::min(values[i], 100.0);
+            int level = std::min((int)(value / 100.0 * 8), 7);
+
+            if (colors) attron(COLOR_PAIR(color_pair_for(value)));
+            addstr(levels[level]);
+            if (colors) attroff(COLOR_PAIR(color_pair_for(value)));
+        }
+    }
+    return rows;
+}
+
+/**
+ * Reduces a history to one level character per sparkline cell
+ * The whole retained history is spread over the cells: each cell shows the
+ * peak of its group of history slots, newest on the right. Cells without data
+ * are ' ', the others '0' (lowest) to '7' (full).
+ * @param history Samples to reduce
+ * @param scale Value drawn as a full cell, or 0.0 to scale to the peak
+ * @param width Number of cells
+ * @param out Output, width characters followed by a NUL
+ */
+void sparkline_levels(const MetricHistory &history, double scale, int width, char *out) {
+    if (scale <= 0.0) scale = std::max((double)history.max(), 1.0);
+
+    const size_t per_cell = std::max<size_t>(1, (history.count + width - 1) / width);
+    const int used_cells = (int)((history.count + per_cell - 1) / per_cell);
+
+    for (int cell = 0; cell < width; ++cell) {
+        out[cell] = ' ';
+        int age = width - 1 - cell;  // Buckets counted back from the newest
+        if (age >= used_cells) continue;
+
+        size_t end = history.count - (size_t)age * per_cell;
+        size_t start = end >= per_cell ? end - per_cell : 0;
+        float peak = -1.0f;
+        for (size_t i = start; i < end; ++i) peak = std::max(peak, history.at(i));
+
+        if (peak >= 0.0f) {
+            out[cell] = (char)('0' + std::min(std::max((int)(peak / scale * 8), 0), 7));
+        }
+    }
+    out[width] = '\0';
+}
+
+/**
+ * Draws a sparkline from levels produced by sparkline_levels()
+ * @param row Y position
+ * @param col X position of the first cell
+ * @param levels Level characters, NUL-terminated
+ */
+void draw_sparkline(int row, int col, const char *levels) {
+    static const char *const blocks[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+
+    move(row, col);
+    for (const char *level = levels; *level; ++level) {
+        addstr(*level == ' ' ? " " : blocks[*level - '0']);
+    }
+}
+
+/**
+ * Retained model of one boxed screen
+ * Every widget inside the box (a text line, a bar, a table row) remembers
+ * the content it last drew, as a signature string, and is only cleared and
+ * redrawn when that changes. The border is drawn once, and again only
+ * after invalidate() (terminal resize, another view was shown) or when the
+ * box size changes. This keeps both the work per frame and the bytes sent
+ * to the terminal proportional to what actually changed.
+ */
+struct RetainedBox {
+    static constexpr int box_x = 2;
+    static constexpr int box_y = 1;
+
+    int box_height = 0;                       // 0 forces a full redraw
+    int box_columns = 0;                      // Width the box was last drawn with
+    std::vector<std::string> row_signatures;  // Last content of each box row
+    bool damaged = false;                     // Something was drawn this frame
+    char line[512];                           // Scratch buffer for formatting
+
+    // Signature of the rows below a multi-row widget's first; no widget
+    // displays it
+    static constexpr const char *continuation_row = "\x01";
+
+    /** Forces a full redraw on the next frame, e.g. after a resize */
+    void invalidate() { box_height = 0; }
+
+    /**
+     * Starts a frame, redrawing the border if the box changed size
+     * @param height Box height including the border
+     * @param width Box width including the border
+     */
+    void begin_frame(int height, int width) {
+        if (height == box_height && width == box_columns) return;
+        erase();
+        box_height = height;
+        box_columns = width;
+        draw_box(box_y, box_x, box_height, box_columns);
+        row_signatures.assign(box_height - 2, std::string());
+        damaged = true;
+    }
+
+    /**
+     * Ends a frame: blanks the rows after the last one drawn, and sends the
+     * changes to the terminal if there were any
+     * @param rows_used Rows drawn inside the box this frame
+     */
+    void end_frame(int rows_used) {
+        for (int row = rows_used; row < box_height - 2; ++row) {
+            widget_changed(row, 1, "");
+        }
+        if (damaged) {
+            refresh();
+            damaged = false;
+        }
+    }
+
+    /**
+     * Checks whether a widget's content differs from what is on screen, and
+     * if so records the new content and blanks the rows it occupies
+     * @param row Index of the widget's first row inside the box
+     * @param rows Number of rows the widget occupies
+     * @param signature Representation of everything the widget displays
+     * @return true if the widget has to be drawn
+     */
+    bool widget_changed(int row, int rows, const char *signature) {
+        bool unchanged = row_signatures[row] == signature;
+        for (int r = row + 1; unchanged && r < row + rows; ++r) {
+            unchanged = row_signatures[r] == continuation_row;
+        }
+        if (unchanged) return false;
+
+        // The other rows are marked too, so that whatever lands on them
+        // after the layout shifts is redrawn instead of leaving this widget
+        // behind
+        row_signatures[row] = signature;
+        for (int r = row + 1; r < row + rows; ++r) row_signatures[r] = continuation_row;
+
+        for (int r = row; r < row + rows; ++r) {
+            mvhline(box_y + 1 + r, box_x + 1, ' ', box_columns - 2);
+        }
+        damaged = true;
+        return true;
+    }
+
+    /**
+     * Draws a line of text if it changed
+     * @param row Index of the row inside the box
+     */
+    void text_row(int row, const char *format, ...) __attribute__((format(printf, 3, 4))) {
+        va_list arguments;
+        va_start(arguments, format);
+        vsnprintf(line, sizeof(line), format, arguments);
+        va_end(arguments);
+
+        if (widget_changed(row, 1, line)) {
+            mvaddstr(box_y + 1 + row, box_x + 2, line);
+        }
+    }
+};
+
+/**
+ * Retained model of the main screen
+ * The static text is drawn once with the border; see RetainedBox.
+ */
+struct Dashboard : RetainedBox {
+    static constexpr int box_width = 76;
+    static constexpr int core_strip_width = box_width - 12;
+    static constexpr int spark_col = box_x + 56;  // Sparklines right of the bars
+    static constexpr int spark_width = 18;
+    static constexpr size_t max_disks = 4;  // Disks shown with I/O rows
+    static constexpr int max_mounts = 6;    // Filesystems shown besides the root
+
+    std::vector<double> core_cells;  // Scratch: core usage by CPU number, -1.0 if offline
+
+    /**
+     * Appends a sparkline's levels to the signature being built in line
+     * @return Offset of the levels within line
+     */
+    size_t append_sparkline(const MetricHistory &history, double scale, int width) {
+        size_t offset = strlen(line);
+        if (offset + width + 1 >= sizeof(line)) offset = sizeof(line) - width - 1;
+        sparkline_levels(history, scale, width, line + offset);
+        return offset;
+    }
+
+    /**
+     * Draws a line of text with a sparkline on the right, if either changed
+     * @param row Index of the row inside the box
+     * @param history Samples for the sparkline
+     * @param scale Value drawn as a full cell, or 0.0 to scale to the peak
+     */
+    void text_row_with_sparkline(int row, const MetricHistory &history, double scale,
+                                 const char *format, ...) __attribute__((format(printf, 5, 6))) {
+        va_list arguments;
+        va_start(arguments, format);
+        vsnprintf(line, sizeof(line), format, arguments);
+        va_end(arguments);
+
+        size_t levels = append_sparkline(history, scale, spark_width);
+        if (widget_changed(row, 1, line)) {
+            mvaddnstr(box_y + 1 + row, box_x + 2, line, (int)levels);
+            draw_sparkline(box_y + 1 + row, spark_col, line + levels);
+        }
+    }
+
+    /**
+     * Updates the screen from a snapshot
+     * @param snapshot Metrics to display
+     * @param history Recent samples, including this snapshot
+     */
+    void render(const Snapshot &snapshot, const History &history) {
+        // Cells by CPU number, so an offline CPU leaves a gap instead of
+        // shifting every core after it
+        core_cells.clear();
+        for (size_t core = 0; core < snapshot.cpu.per_core.size(); ++core) {
+            size_t id = (size_t)snapshot.cpu.core_ids[core];
+            if (id >= core_cells.size()) core_cells.resize(id + 1, -1.0);
+            core_cells[id] = snapshot.cpu.per_core[core];
+        }
+
+        // Box dimensions; the per-core strip grows with the core count
+        const int core_strip_rows = heat_strip_rows(core_cells.size(), core_strip_width);
+        const size_t disks = std::min(snapshot.disk_io.size(), max_disks);
+        int mounts = 0;
+        for (const FilesystemUsage &filesystem : snapshot.filesystems) {
+            if (filesystem.mount_point != "/") mounts++;
+        }
+        mounts = std::min(mounts, max_mounts);
+        int pressure_rows = 0;
+        for (const Pressure &resource : snapshot.pressure) {
+            if (resource.some.avg10 >= 0) pressure_rows = 1;
+        }
+        const int height = 18 + core_strip_rows + pressure_rows + mounts + 2 * (int)disks;
+
+        // Draw the main container box and static text only when needed
+        begin_frame(height, box_width);
+
+        // Display system information inside the box
+        int current_row = 0;
+
+        text_row(current_row++, "%-58s every %5.2fs", "Mini System Monitor", snapshot.interval);
+        text_row(current_row++, "────────────────────────────────────────────────");
+
+        text_row(current_row++, "Host: %s", snapshot.hostname.c_str());
+        text_row(current_row++, "User: %s", snapshot.username.c_str());
+        text_row(current_row++, "Uptime: %s", format_uptime(snapshot.uptime).c_str());
+
+        // Display temperature if available
+        if (snapshot.temperature >= 0) {
+            text_row_with_sparkline(current_row++, history.temperature, 100.0,
+                                    "Temperature: %.1f°C", snapshot.temperature);
+        } else {
+            text_row(current_row++, "Temperature: Not available");
+        }
+
+        // Display network transfer rates, with receive and send sparklines
+        // each scaled to their own recent peak
+        snprintf(line, sizeof(line), "Network: ↓ %s/s  ↑ %s/s",
+                 format_bytes(snapshot.rx_rate).c_str(),
+                 format_bytes(snapshot.tx_rate).c_str());
+        const int half_spark = spark_width / 2 - 1;
+        size_t text_length = strlen(line);
+        size_t rx_levels = append_sparkline(history.rx, 0.0, half_spark);
+        line[rx_levels + half_spark] = '|';
+        line[rx_levels + half_spark + 1] = '\0';
+        size_t tx_levels = append_sparkline(history.tx, 0.0, half_spark);
+        if (widget_changed(current_row, 1, line)) {
+            int row = box_y + 1 + current_row;
+            mvaddnstr(row, box_x + 2, line, (int)text_length);
+            line[rx_levels + half_spark] = '\0';
+            mvaddstr(row, spark_col, "↓");
+            draw_sparkline(row, spark_col + 1, line + rx_levels);
+            mvaddstr(row, spark_col + half_spark + 1, "↑");
+            draw_sparkline(row, spark_col + half_spark + 2, line + tx_levels);
+        }
+        current_row++;
+
+        current_row++; // Add spacing before progress bars
+
+        // Draw progress bars for system usage
+        const int col = box_x + 2;
+        if (snapshot.cpu.total >= 0) {
+            const CpuBreakdown &cpu = snapshot.cpu.breakdown;
+            snprintf(line, sizeof(line), "cpu %.2f %.1f %.1f %.1f %.1f %.1f %.1f %.1f %.1f",
+                     snapshot.cpu.total, cpu.user, cpu.nice, cpu.system, cpu.irq,
+                     cpu.softirq, cpu.steal, cpu.guest, cpu.iowait);
+            size_t levels = append_sparkline(history.cpu, 100.0, spark_width);
+            if (widget_changed(current_row, 2, line)) {
+                draw_cpu_breakdown(box_y + 1 + current_row, col, cpu);
+                draw_sparkline(box_y + 1 + current_row, spark_col, line + levels);
+            }
+            current_row += 2;
+        } else if (!snapshot.cpu.per_core.empty()) {
+            // Counters were reset (e.g. a core went on- or offline); keep the
+            // layout and wait for a sample with a usable delta
+            if (widget_changed(current_row, 2, "cpu reset")) {
+                mvprintw(box_y + 1 + current_row, col, "%-*s", box_width - 4,
+                         "CPU   counters reset, waiting for the next sample");
+                mvprintw(box_y + 2 + current_row, col, "%-*s", box_width - 4, "");
+            }
+            current_row += 2;
+        }
+
+        // One signature per strip row: the level of each core on it, or ' '
+        // for a core without a usable sample
+        const std::vector<double> &cores = core_cells;
+        for (int r = 0; r < core_strip_rows; ++r) {
+            size_t first = (size_t)r * core_strip_width;
+            size_t count = std::min(cores.size() - first, (size_t)core_strip_width);
+            for (size_t i = 0; i < count; ++i) {
+                double core = cores[first + i];
+                line[i] = core < 0.0 ? ' ' : (char)('0' + std::min((int)(core / 100.0 * 8), 7));
+            }
+            line[count] = '\0';
+            if (widget_changed(current_row, 1, line)) {
+                draw_heat_strip(box_y + 1 + current_row, col, cores.data() + first, count,
+                                r == 0 ? "Cores" : "     ", core_strip_width);
+            }
+            current_row++;
+        }
+
+        // Load per online CPU, so 1.00 means a saturated machine whatever
+        // its size, then the task counts and scheduler rates
+        const SchedulerActivity &scheduler = snapshot.scheduler;
+        const double cpus = (double)std::max<size_t>(snapshot.cpu.per_core.size(), 1);
+        char context_switches[16] = "-", forks[16] = "-";
+        if (scheduler.rates_valid) {
+            format_count_short(scheduler.context_switches, context_switches, sizeof(context_switches));
+            format_count_short(scheduler.forks, forks, sizeof(forks));
+        }
+        snprintf(line, sizeof(line), "load %.2f %.2f %.2f %llu %llu %s %s", scheduler.load[0],
+                 scheduler.load[1], scheduler.load[2], scheduler.running, scheduler.blocked,
+                 context_switches, forks);
+        if (widget_changed(current_row, 1, line)) {
+            int row = box_y + 1 + current_row;
+            mvprintw(row, col, "%-*s", box_width - 4, "Load");
+            move(row, col + 7);
+            if (scheduler.load[0] < 0) {
+                addstr("not available  ");
+            } else {
+                for (double average : scheduler.load) {
+                    double per_cpu = average / cpus;
+                    bool alert = per_cpu >= 1.0 && has_colors();
+                    if (alert) attron(COLOR_PAIR(COLOR_PAIR_HIGH) | A_BOLD);
+                    printw("%.2f ", per_cpu);
+                    if (alert) attroff(COLOR_PAIR(COLOR_PAIR_HIGH) | A_BOLD);
+                }
+                addstr("/cpu   ");
+            }
+            printw("run %llu  blk %llu   ctxt %s/s  fork %s/s", scheduler.running, scheduler.blocked,
+                   context_switches, forks);
+        }
+        current_row++;
+
+        if (snapshot.ram_usage >= 0) {
+            const MemoryInfo &memory = snapshot.memory;
+            snprintf(line, sizeof(line), "ram %.2f %llu %llu %llu %llu %llu %llu %llu %llu ",
+                     snapshot.ram_usage, memory.total, memory.anon, memory.kernel(), memory.shmem,
+                     memory.reclaimable_cache(), memory.swap_free, memory.dirty, memory.writeback);
+            size_t levels = append_sparkline(history.ram, 100.0, spark_width);
+            if (widget_changed(current_row, 2, line)) {
+                draw_memory_breakdown(box_y + 1 + current_row, col, memory);
+                draw_sparkline(box_y + 1 + current_row, spark_col, line + levels);
+            }
+            current_row += 2;
+        }
+
+        // Share of the interval tasks spent stalled on each resource; the
+        // label is highlighted when a kernel trigger started this sample
+        if (pressure_rows) {
+            auto stalled = [](const PressureLine &line, double interval_percent) {
+                return interval_percent >= 0 ? interval_percent : line.avg10;
+            };
+            const Pressure &cpu = snapshot.pressure[PRESSURE_CPU];
+            const Pressure &memory = snapshot.pressure[PRESSURE_MEMORY];
+            const Pressure &io = snapshot.pressure[PRESSURE_IO];
+            const struct {
+                const char *name;
+                double value;
+            } figures[] = {
+                {"  cpu ", stalled(cpu.some, cpu.some_percent)},
+                {"  mem ", stalled(memory.some, memory.some_percent)},
+                {" full ", stalled(memory.full, memory.full_percent)},
+                {"  io ", stalled(io.some, io.some_percent)},
+                {" full ", stalled(io.full, io.full_percent)},
+            };
+
+            size_t length = (size_t)snprintf(line, sizeof(line), "stall %d", (int)snapshot.stall_event);
+            for (const auto &figure : figures) {
+                length += (size_t)snprintf(line + length, sizeof(line) - length, " %.1f", figure.value);
+            }
+            if (widget_changed(current_row, 1, line)) {
+                const bool colors = has_colors();
+                move(box_y + 1 + current_row, col);
+                if (snapshot.stall_event) attron(A_REVERSE);
+                addstr("Stall");
+                if (snapshot.stall_event) attroff(A_REVERSE);
+                for (const auto &figure : figures) {
+                    addstr(figure.name);
+                    if (figure.value < 0) {
+                        addstr("    - ");
+                        continue;
+                    }
+                    bool alert = figure.value >= 10.0 && colors;
+                    if (alert) attron(COLOR_PAIR(COLOR_PAIR_HIGH) | A_BOLD);
+                    printw("%5.1f%%", figure.value);
+                    if (alert) attroff(COLOR_PAIR(COLOR_PAIR_HIGH) | A_BOLD);
+                }
+            }
+            current_row++;
+        }
+
+        // Paging and reclaim per second. OOM kills, allocation stalls,
+        // direct reclaim and direct compaction stall the allocating task, so
+        // they come first (a busy row drops entries from the end) and are
+        // flagged when nonzero.
+        const VmstatRates &vm = snapshot.vmstat;
+        if (vm.valid) {
+            LegendEntry legend[] = {
+                {"oom", "", COLOR_PAIR_HIGH},
+                {"astall", "", COLOR_PAIR_HIGH},
+                {"dscan", "", COLOR_PAIR_HIGH},
+                {"cstall", "", COLOR_PAIR_HIGH},
+                {"majflt", "", 0},
+                {"si", "", 0},
+                {"so", "", 0},
+                {"kscan", "", 0},
+            };
+            const double rates[] = {
+                vm.oom_kills, vm.alloc_stalls, vm.scan_direct, vm.compact_stalls,
+                vm.major_faults, vm.swap_in, vm.swap_out, vm.scan_kswapd,
+            };
+            size_t length = (size_t)snprintf(line, sizeof(line), "VM/s  ");
+            for (size_t i = 0; i < std::size(legend); ++i) {
+                LegendEntry &entry = legend[i];
+                if (rates[i] == 0.0) entry.color_pair = 0;
+                snprintf(entry.value, sizeof(entry.value),
+                         rates[i] >= 1000.0 ? " %.0fk" : " %.0f",
+                         rates[i] >= 1000.0 ? rates[i] / 1000.0 : rates[i]);
+                length += (size_t)snprintf(line + length, sizeof(line) - length, "%s%s ",
+                                           entry.name, entry.value);
+            }
+            if (widget_changed(current_row, 1, line)) {
+                int row = box_y + 1 + current_row;
+                mvprintw(row, col, "%-*s", box_width - 4, "VM/s");
+                draw_legend(row, col + 7, legend, std::size(legend), box_width - 4 - 7);
+            }
+        } else {
+            text_row(current_row, "%-*s", box_width - 4, "VM/s   waiting for the next sample");
+        }
+        current_row++;
+
+        if (snapshot.disk_usage >= 0) {
+            snprintf(line, sizeof(line), "disk %.2f ", snapshot.disk_usage);
+            size_t levels = append_sparkline(history.disk, 100.0, spark_width);
+            if (widget_changed(current_row, 1, line)) {
+                draw_progress_bar(box_y + 1 + current_row, col, snapshot.disk_usage, "Disk ");
+                draw_sparkline(box_y + 1 + current_row, spark_col, line + levels);
+            }
+            current_row++;
+        }
+
+        // Other filesystems, named where the root's sparkline goes
+        int mount_rows = 0;
+        for (const FilesystemUsage &filesystem : snapshot.filesystems) {
+            if (filesystem.mount_point == "/") continue;
+            if (mount_rows++ == mounts) break;
+
+            snprintf(line, sizeof(line), "%s %.2f %d", filesystem.mount_point.c_str(),
+                     filesystem.usage, (int)filesystem.hung);
+            if (widget_changed(current_row, 1, line)) {
+                int row = box_y + 1 + current_row;
+                if (filesystem.usage >= 0) {
+                    draw_progress_bar(row, col, filesystem.usage, "     ");
+                } else {
+                    mvaddstr(row, col, filesystem.hung ? "      not responding" : "      not available");
+                }
+                // Long paths keep their last components, which tell mounts apart
+                const std::string &path = filesystem.mount_point;
+                if ((int)path.size() > spark_width) {
+                    mvaddstr(row, spark_col, "…");
+                    addstr(path.c_str() + path.size() - (spark_width - 1));
+                } else {
+                    mvaddstr(row, spark_col, path.c_str());
+                }
+            }
+            current_row++;
+        }
+
+        // Per-disk throughput and latency above a utilization bar
+        for (size_t d = 0; d < disks; ++d) {
+            const DiskIo &io = snapshot.disk_io[d];
+            if (!io.valid) {
+                snprintf(line, sizeof(line), "%-7.7s no rate yet (new device or counters reset)",
+                         io.name);
+                if (widget_changed(current_row, 2, line)) {
+                    mvprintw(box_y + 1 + current_row, col, "%-*s", box_width - 4, line);
+                    mvprintw(box_y + 2 + current_row, col, "%-*s", box_width - 4, "");
+                }
+                current_row += 2;
+                continue;
+            }
+            snprintf(line, sizeof(line), "%-7.7s r %5.0f/s %10s/s  w %5.0f/s %10s/s  await %6.2fms",
+                     io.name, io.reads_per_sec, format_bytes((ull)io.read_bytes_per_sec).c_str(),
+                     io.writes_per_sec, format_bytes((ull)io.write_bytes_per_sec).c_str(),
+                     io.await_ms);
+            size_t text_length = strlen(line);
+            snprintf(line + text_length, sizeof(line) - text_length, "%.1f", io.utilization);
+            if (widget_changed(current_row, 2, line)) {
+                mvaddnstr(box_y + 1 + current_row, col, line, (int)text_length);
+                draw_progress_bar(box_y + 2 + current_row, col, io.utilization, "Util ");
+            }
+            current_row += 2;
+        }
+
+        // Rows no longer in use (e.g. a collector started failing) are
+        // blanked, then the display is updated
+        end_frame(current_row);
+    }
+};
+
+/**
+ * Table of per-interface network rates, sortable by any column
+ * Shown instead of the dashboard while toggled with 'n'; 's' moves to the
+ * next sort column. Like the dashboard, only rows whose content changed
+ * are redrawn.
+ */
+struct NetworkTable : RetainedBox {
+    enum SortColumn {
+        SORT_NAME,
+        SORT_RX_BYTES,
+        SORT_TX_BYTES,
+        SORT_RX_PACKETS,
+        SORT_TX_PACKETS,
+        SORT_ERRORS,
+        SORT_DROPS,
+        SORT_FIFO,
+        SORT_COLUMNS,
+    };
+
+    static constexpr int box_width = Dashboard::box_width;
+
+    SortColumn sort_column = SORT_RX_BYTES;
+    std::vector<const InterfaceRates *> rows;  // Scratch, in display order
+
+    /** Advances to the next sort column */
+    void next_sort_column() { sort_column = (SortColumn)((sort_column + 1) % SORT_COLUMNS); }
+
+    /** Value of the sort column for an interface; larger sorts first */
+    double sort_value(const InterfaceRates &rates) const {
+        switch (sort_column) {
+        case SORT_RX_BYTES: return rates.rx_bytes;
+        case SORT_TX_BYTES: return rates.tx_bytes;
+        case SORT_RX_PACKETS: return rates.rx_packets;
+        case SORT_TX_PACKETS: return rates.tx_packets;
+        case SORT_ERRORS: return rates.rx_errors + rates.tx_errors;
+        case SORT_DROPS: return rates.rx_drops + rates.tx_drops;
+        case SORT_FIFO: return rates.rx_fifo + rates.tx_fifo;
+        default: return 0.0;
+        }
+    }
+
+    /**
+     * Draws the table for a snapshot
+     * @param snapshot Metrics to display
+     */
+    void render(const Snapshot &snapshot) {
+        static const char *const column_names[SORT_COLUMNS] = {
+            "Interface", "RX/s", "TX/s", "RX pkt/s", "TX pkt/s", "Err/s", "Drop/s", "FIFO/s",
+        };
+
+        rows.clear();
+        for (const InterfaceRates &rates : snapshot.interfaces) {
+            rows.push_back(&rates);
+        }
+        std::stable_sort(rows.begin(), rows.end(), [this](const InterfaceRates *a, const InterfaceRates *b) {
+            if (sort_column == SORT_NAME) return strcmp(a->name, b->name) < 0;
+            return sort_value(*a) > sort_value(*b);
+        });
+
+        // Rows that do not fit the terminal are left out
+        const int visible = std::max(std::min((int)rows.size(), LINES - box_y - 6), 0);
+        begin_frame(visible + 6, box_width);
+
+        const int col = box_x + 2;
+        int row = 0;
+        text_row(row++, "Network interfaces, sorted by %s   (s: sort, n: back)",
+                 column_names[sort_column]);
+        text_row(row++, "────────────────────────────────────────────────");
+
+        // Header, with the sort column highlighted
+        static const int column_offsets[SORT_COLUMNS] = {0, 11, 22, 33, 42, 51, 58, 65};
+        static const int column_widths[SORT_COLUMNS] = {-10, 10, 10, 8, 8, 6, 6, 6};
+        snprintf(line, sizeof(line), "header %d", (int)sort_column);
+        if (widget_changed(row, 1, line)) {
+            for (int c = 0; c < SORT_COLUMNS; ++c) {
+                if (c == sort_column) attron(A_REVERSE);
+                mvprintw(box_y + 1 + row, col + column_offsets[c], "%*s", column_widths[c], column_names[c]);
+                if (c == sort_column) attroff(A_REVERSE);
+            }
+        }
+        row++;
+
+        for (int i = 0; i < visible; ++i) {
+            const InterfaceRates &rates = *rows[i];
+            if (!rates.valid) {
+                text_row(row++, "%-10.10s %10s", rates.name, "no rate yet");
+                continue;
+            }
+
+            // Any loss is worth noticing, so nonzero counts stand out; the
+            // signature ends with the alert flags, which are not drawn
+            const double losses[] = {
+                rates.rx_errors + rates.tx_errors,
+                rates.rx_drops + rates.tx_drops,
+                rates.rx_fifo + rates.tx_fifo,
+            };
+            int text_length = snprintf(line, sizeof(line), "%-10.10s %10s %10s %8.0f %8.0f %6.0f %6.0f %6.0f",
+                                       rates.name, format_bytes((ull)rates.rx_bytes).c_str(),
+                                       format_bytes((ull)rates.tx_bytes).c_str(), rates.rx_packets,
+                                       rates.tx_packets, losses[0], losses[1], losses[2]);
+            snprintf(line + text_length, sizeof(line) - text_length, "|%d%d%d",
+                     losses[0] > 0.0, losses[1] > 0.0, losses[2] > 0.0);
+            if (widget_changed(row, 1, line)) {
+                mvaddnstr(box_y + 1 + row, col, line, text_length);
+                for (int c = 0; c < 3; ++c) {
+                    if (losses[c] <= 0.0 || !has_colors()) continue;
+                    attron(COLOR_PAIR(COLOR_PAIR_HIGH) | A_BOLD);
+                    mvprintw(box_y + 1 + row, col + column_offsets[SORT_ERRORS + c], "%6.0f", losses[c]);
+                    attroff(COLOR_PAIR(COLOR_PAIR_HIGH) | A_BOLD);
+                }
+            }
+            row++;
+        }
+        if (visible < (int)rows.size()) {
+            text_row(row++, "... %d more", (int)rows.size() - visible);
+        }
+
+        end_frame(row);
+    }
+};
+
+/**
+ * Heatmap of softirq and interrupt rates per CPU
+ * Shown instead of the dashboard while toggled with 'i'. Each row is one
+ * softirq type or active interrupt source, each cell one CPU, shaded
+ * relative to the busiest CPU of that row: a queue pinned to a single CPU
+ * shows as one full block in an otherwise empty row. Hosts with more CPUs
+ * than cells fold adjacent CPUs into one cell showing their peak. Like the
+ * dashboard, only rows whose content changed are redrawn.
+ */
+struct InterruptHeatmap : RetainedBox {
+    static constexpr int name_width = 16;
+
+    struct Line {
+        const InterruptRates *rates;  // Null for a section heading
+        size_t row;
+        double total;                 // Sum over all CPUs, per second
+    };
+    std::vector<Line> lines;  // Scratch, in display order
+
+    /** Adds the rows of a table, optionally only active ones sorted busiest first */
+    void add_rows(const InterruptRates &rates, bool active_only) {
+        const size_t first = lines.size();
+        const size_t columns = rates.cpu_ids.size();
+        for (size_t row = 0; row < rates.rows(); ++row) {
+            const float *values = &rates.rates[row * columns];
+            double total = std::accumulate(values, values + columns, 0.0);
+            if (active_only && (total <= 0.0 || !rates.row_valid[row])) continue;
+            lines.push_back({&rates, row, total});
+        }
+        if (active_only) {
+            std::stable_sort(lines.begin() + first, lines.end(),
+                             [](const Line &a, const Line &b) { return a.total > b.total; });
+        }
+    }
+
+    /**
+     * Draws one row if it changed: name, one cell per group of CPUs and the
+     * total rate
+     * @param row Index of the row inside the box
+     * @param entry Source to draw
+     * @param per_cell CPUs folded into one cell
+     */
+    void draw_line(int row, const Line &entry, int per_cell) {
+        static const char *const levels[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+        const InterruptRates &rates = *entry.rates;
+        const size_t columns = rates.cpu_ids.size();
+        const float *values = &rates.rates[entry.row * columns];
+        const double peak = columns > 0 ? *std::max_element(values, values + columns) : 0.0;
+        auto cell_value = [&](size_t first) {
+            return *std::max_element(values + first, values + std::min(first + per_cell, columns));
+        };
+
+        // Signature: name, total and the level of every cell, or ' ' for an
+        // empty one
+        char total[16];
+        format_count_short(entry.total, total, sizeof(total));
+        size_t length = (size_t)snprintf(line, sizeof(line), "%s|%s|%c", rates.names[entry.row].c_str(),
+                                         total, rates.row_valid[entry.row] ? 'v' : 'r');
+        length = std::min(length, sizeof(line) - 1);
+        for (size_t first = 0; first < columns && length < sizeof(line) - 1; first += per_cell) {
+            double value = cell_value(first);
+            line[length++] = value <= 0.0 || peak <= 0.0
+                                 ? ' '
+                                 : (char)('0' + std::min((int)(value / peak * 8), 7));
+        }
+        line[length] = '\0';
+        if (!widget_changed(row, 1, line)) return;
+
+        const int y = box_y + 1 + row;
+        const int col = box_x + 2;
+        mvprintw(y, col, "%-*.*s │", name_width, name_width, rates.names[entry.row].c_str());
+        if (!rates.row_valid[entry.row]) {
+            addstr("counters reset, waiting for the next sample");
+            return;
+        }
+
+        const bool colors = has_colors();
+        for (size_t first = 0; first < columns; first += per_cell) {
+            const double value = cell_value(first);
+            if (value <= 0.0 || peak <= 0.0) {
+                addstr(" ");
+                continue;
+            }
+            double percentage = value / peak * 100.0;
+            int level = std::min((int)(percentage / 100.0 * 8), 7);
+            if (colors) attron(COLOR_PAIR(color_pair_for(percentage)));
+            addstr(levels[level]);
+            if (colors) attroff(COLOR_PAIR(color_pair_for(percentage)));
+        }
+
+        int cells = (int)((columns + per_cell - 1) / per_cell);
+        mvprintw(y, col + name_width + 2 + cells, "│ %6s/s", total);
+    }
+
+    /**
+     * Updates the screen from a snapshot
+     * @param snapshot Metrics to display
+     */
+    void render(const Snapshot &snapshot) {
+        lines.clear();
+        if (snapshot.softirqs.valid) {
+            lines.push_back({nullptr, 0, 0.0});
+            add_rows(snapshot.softirqs, false);
+        }
+        if (snapshot.interrupts.valid) {
+            lines.push_back({nullptr, 1, 0.0});
+            add_rows(snapshot.interrupts, true);
+        }
+
+        // Column layout follows the terminal width; extra CPUs share cells
+        const InterruptRates &ruler = snapshot.softirqs.valid ? snapshot.softirqs : snapshot.interrupts;
+        const int width = std::max(Dashboard::box_width, COLS - 2 * box_x);
+        const int available = std::max(width - 4 - name_width - 2 - 10, 1);
+        const int cpus = std::max((int)ruler.cpu_ids.size(), 1);
+        const int per_cell = (cpus + available - 1) / available;
+        const int cells = (cpus + per_cell - 1) / per_cell;
+
+        // Lines that do not fit the terminal are left out, busiest kept
+        const int fit = std::max(LINES - box_y - 6, 0);
+        const int visible = std::min((int)lines.size(), fit);
+        begin_frame(std::max(visible, 1) + 5 + (visible < (int)lines.size()), width);
+
+        int row = 0;
+        if (per_cell > 1) {
+            text_row(row++, "Interrupts per CPU, %d CPUs per cell, shaded per row   (i: back)", per_cell);
+        } else {
+            text_row(row++, "Interrupts per CPU, shaded per row   (i: back)");
+        }
+        text_row(row++, "────────────────────────────────────────────────");
+
+        // CPU ruler: the first CPU of every tenth cell
+        char ruler_cells[512];
+        const int ruler_width = std::min(cells, (int)sizeof(ruler_cells) - 1);
+        memset(ruler_cells, ' ', ruler_width);
+        ruler_cells[ruler_width] = '\0';
+        for (int cell = 0; cell < ruler_width; cell += 10) {
+            if (cell * per_cell >= (int)ruler.cpu_ids.size()) break;
+            char id[12];
+            int id_length = snprintf(id, sizeof(id), "%d", ruler.cpu_ids[cell * per_cell]);
+            memcpy(ruler_cells + cell, id, std::min(id_length, ruler_width - cell));
+        }
+        text_row(row++, "%-*s │%s│ %8s", name_width, "CPU", ruler_cells, "total");
+
+        if (lines.empty()) {
+            text_row(row++, "Waiting for the next sample");
+        }
+        for (int i = 0; i < visible; ++i, ++row) {
+            const Line &entry = lines[i];
+            if (!entry.rates) {
+                const char *heading = entry.row == 0 ? "Softirqs" : "Hardware interrupts, busiest first";
+                if (widget_changed(row, 1, heading)) {
+                    attron(A_BOLD);
+                    mvaddstr(box_y + 1 + row, box_x + 2, heading);
+                    attroff(A_BOLD);
+                }
+                continue;
+            }
+            draw_line(row, entry, per_cell);
+        }
+        if (visible < (int)lines.size()) {
+            text_row(row++, "... %d more", (int)(lines.size() - visible));
+        }
+
+        end_frame(row);
+    }
+};
+
+/**
+ * Blocks signals in the calling thread (and threads it starts later) and
+ * routes them to a signalfd so the main loop can poll() for them
+ * @param signals Signals to redirect
+ * @return File descriptor; throws std::system_error on failure
+ */
+int create_signalfd(std::initializer_list<int> signals) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int signal_number : signals) {
+        sigaddset(&mask, signal_number);
+    }
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+    int fd = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "signalfd");
+    }
+    return fd;
+}
+
+/**
+ * Adopts the terminal's new size after SIGWINCH
+ * ncurses never sees the signal since it is delivered through a signalfd.
+ */
+void handle_resize() {
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0) {
+        resizeterm(size.ws_row, size.ws_col);
+    }
+}
+
+// =============================================================================
+// NDJSON OUTPUT
+// =============================================================================
+
+/**
+ * Builds compact JSON in a reusable buffer
+ * Separators are inserted automatically based on the preceding character.
+ */
+struct JsonWriter : OutputBuffer {
+    using OutputBuffer::number;
+
+    /** Writes a fixed-point number, or null if it is not finite */
+    void number(double value, int decimals) {
+        if (std::isfinite(value)) {
+            OutputBuffer::number(value, decimals);
+        } else {
+            put("null", 4);
+        }
+    }
+
+    /** Writes a comma unless this is the first member of an object or array */
+    void separate() {
+        if (length > 0) {
+            char last = buffer[length - 1];
+            if (last != '{' && last != '[' && last != ':') put(',');
+        }
+    }
+
+    /** Writes a member name; names are plain ASCII and need no escaping */
+    void key(const char *name) {
+        separate();
+        put('"');
+        put(name, strlen(name));
+        put('"');
+        put(':');
+    }
+
+    void begin_object(const char *name = nullptr) {
+        if (name) key(name); else separate();
+        put('{');
+    }
+    void end_object() { put('}'); }
+
+    void begin_array(const char *name) {
+        key(name);
+        put('[');
+    }
+    void end_array() { put(']'); }
+
+    /** Writes a string, escaping quotes, backslashes and control characters */
+    void string(std::string_view text) {
+        static const char hex[] = "0123456789abcdef";
+        put('"');
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                put('\\');
+                put(c);
+            } else if ((unsigned char)c < 0x20) {
+                put("\\u00", 4);
+                put(hex[(unsigned char)c >> 4]);
+                put(hex[c & 0xf]);
+            } else {
+                put(c);
+            }
+        }
+        put('"');
+    }
+
+    void field(const char *name, ull value) { key(name); number(value); }
+    void field(const char *name, double value, int decimals) { key(name); number(value, decimals); }
+    void field(const char *name, std::string_view value) { key(name); string(value); }
+    void field(const char *name, bool value) {
+        key(name);
+        if (value) put("true", 4); else put("false", 5);
+    }
+
+    /** Writes an array element */
+    void element(double value, int decimals) { separate(); number(value, decimals); }
+};
+
+/**
+ * Serializes a snapshot as one JSON object followed by a newline
+ * Unavailable metrics (reported as negative values) are written as null.
+ * @param snapshot Metrics to serialize
+ * @param json Writer to append to
+ */
+void write_snapshot_json(const Snapshot &snapshot, JsonWriter &json) {
+    auto optional = [](double value) { return value >= 0 ? value : NAN; };
+
+    json.begin_object();
+    json.field("time", snapshot.wall_time, 3);
+    json.field("interval", snapshot.interval, 3);
+    json.field("host", snapshot.hostname);
+    json.field("user", snapshot.username);
+    json.field("uptime", snapshot.uptime, 2);
+
+    const CpuUsage &cpu = snapshot.cpu;
+    // The breakdown is only meaningful alongside a known total
+    auto state = [&cpu](double value) { return cpu.total >= 0 ? value : NAN; };
+    json.begin_object("cpu");
+    json.field("total", optional(cpu.total), 2);
+    json.field("user", state(cpu.breakdown.user), 2);
+    json.field("nice", state(cpu.breakdown.nice), 2);
+    json.field("system", state(cpu.breakdown.system), 2);
+    json.field("irq", state(cpu.breakdown.irq), 2);
+    json.field("softirq", state(cpu.breakdown.softirq), 2);
+    json.field("steal", state(cpu.breakdown.steal), 2);
+    json.field("guest", state(cpu.breakdown.guest), 2);
+    json.field("iowait", state(cpu.breakdown.iowait), 2);
+    json.field("idle", state(cpu.breakdown.idle), 2);
+    json.begin_array("cores");
+    for (double core : cpu.per_core) {
+        json.element(optional(core), 1);
+    }
+    json.end_array();
+    json.begin_array("core_ids");
+    for (int core_id : cpu.core_ids) {
+        json.element(core_id, 0);
+    }
+    json.end_array();
+    json.end_object();
+
+    const SchedulerActivity &scheduler = snapshot.scheduler;
+    const double cpus = (double)std::max<size_t>(cpu.per_core.size(), 1);
+    auto rate = [&scheduler](double value) { return scheduler.rates_valid ? value : NAN; };
+    json.begin_object("load");
+    json.field("avg1", optional(scheduler.load[0]), 2);
+    json.field("avg5", optional(scheduler.load[1]), 2);
+    json.field("avg15", optional(scheduler.load[2]), 2);
+    json.field("avg1_per_cpu", optional(scheduler.load[0] / cpus), 3);
+    json.field("procs_running", scheduler.running);
+    json.field("procs_blocked", scheduler.blocked);
+    json.field("context_switches_per_sec", rate(scheduler.context_switches), 1);
+    json.field("interrupts_per_sec", rate(scheduler.interrupts), 1);
+    json.field("forks_per_sec", rate(scheduler.forks), 1);
+    json.end_object();
+
+    json.field("ram", optional(snapshot.ram_usage), 2);
+    json.begin_object("memory_kib");
+    for (size_t field = 0; field < std::size(meminfo_keys); ++field) {
+        json.field(meminfo_keys[field].data(), snapshot.memory.*meminfo_fields[field]);
+    }
+    json.end_object();
+
+    static const char *const resource_names[PRESSURE_RESOURCES] = {"cpu", "memory", "io"};
+    json.begin_object("pressure");
+    json.field("stall_event", snapshot.stall_event);
+    for (int resource = 0; resource < PRESSURE_RESOURCES; ++resource) {
+        const Pressure &pressure = snapshot.pressure[resource];
+        json.begin_object(resource_names[resource]);
+        const struct {
+            const char *kind;
+            const PressureLine &line;
+            double interval_percent;
+        } kinds[] = {
+            {"some", pressure.some, pressure.some_percent},
+            {"full", pressure.full, pressure.full_percent},
+        };
+        for (const auto &kind : kinds) {
+            json.begin_object(kind.kind);
+            json.field("avg10", optional(kind.line.avg10), 2);
+            json.field("avg60", optional(kind.line.avg60), 2);
+            json.field("interval", optional(kind.interval_percent), 2);
+            json.field("total_us", kind.line.total);
+            json.end_object();
+        }
+        json.end_object();
+    }
+    json.end_object();
+
+    json.begin_object("vmstat_per_sec");
+    for (const auto &entry : vmstat_rates) {
+        json.field(entry.name, snapshot.vmstat.valid ? snapshot.vmstat.*entry.rate : NAN, 1);
+    }
+    json.end_object();
+
+    json.field("disk", optional(snapshot.disk_usage), 2);
+    json.begin_array("filesystems");
+    for (const FilesystemUsage &filesystem : snapshot.filesystems) {
+        json.begin_object();
+        json.field("mount_point", filesystem.mount_point);
+        json.field("type", filesystem.fs_type);
+        json.field("usage", optional(filesystem.usage), 2);
+        json.field("hung", filesystem.hung);
+        json.end_object();
+    }
+    json.end_array();
+    json.field("temperature", optional(snapshot.temperature), 1);
+
+    json.begin_object("net");
+    json.field("rx_bytes_per_sec", snapshot.rx_rate);
+    json.field("tx_bytes_per_sec", snapshot.tx_rate);
+    json.begin_array("interfaces");
+    for (const InterfaceRates &rates : snapshot.interfaces) {
+        json.begin_object();
+        auto rate = [&rates](double value) { return rates.valid ? value : NAN; };
+        json.field("name", std::string_view(rates.name));
+        json.field("rx_bytes_per_sec", rate(rates.rx_bytes), 0);
+        json.field("rx_packets_per_sec", rate(rates.rx_packets), 1);
+        json.field("rx_errors_per_sec", rate(rates.rx_errors), 1);
+        json.field("rx_drops_per_sec", rate(rates.rx_drops), 1);
+        json.field("rx_fifo_per_sec", rate(rates.rx_fifo), 1);
+        json.field("tx_bytes_per_sec", rate(rates.tx_bytes), 0);
+        json.field("tx_packets_per_sec", rate(rates.tx_packets), 1);
+        json.field("tx_errors_per_sec", rate(rates.tx_errors), 1);
+        json.field("tx_drops_per_sec", rate(rates.tx_drops), 1);
+        json.field("tx_fifo_per_sec", rate(rates.tx_fifo), 1);
+        json.end_object();
+    }
+    json.end_array();
+    json.end_object();
+
+    json.begin_array("disk_io");
+    for (const DiskIo &io : snapshot.disk_io) {
+        json.begin_object();
+        auto rate = [&io](double value) { return io.valid ? value : NAN; };
+        json.field("device", std::string_view(io.name));
+        json.field("reads_per_sec", rate(io.reads_per_sec), 1);
+        json.field("writes_per_sec", rate(io.writes_per_sec), 1);
+        json.field("read_bytes_per_sec", rate(io.read_bytes_per_sec), 0);
+        json.field("write_bytes_per_sec", rate(io.write_bytes_per_sec), 0);
+        json.field("await_ms", rate(io.await_ms), 2);
+        json.field("utilization", rate(io.utilization), 1);
+        json.end_object();
+    }
+    json.end_array();
+
+    // Every softirq type per CPU. Hardware interrupts only as totals per
+    // CPU and for the busiest sources, as in the Prometheus output: one
+    // array per IRQ would be thousands of numbers per line on big hosts.
+    json.begin_object("interrupts_per_sec");
+    const InterruptRates &softirqs = snapshot.softirqs;
+    json.begin_array("softirqs");
+    for (size_t row = 0; softirqs.valid && row < softirqs.rows(); ++row) {
+        const size_t columns = softirqs.cpu_ids.size();
+        json.begin_object();
+        json.field("name", softirqs.labels[row]);
+        json.begin_array("per_cpu");
+        for (size_t column = 0; column < columns; ++column) {
+            json.element(softirqs.row_valid[row] ? softirqs.rates[row * columns + column] : NAN, 1);
+        }
+        json.end_array();
+        json.end_object();
+    }
+    json.end_array();
+
+    const InterruptRates &interrupts = snapshot.interrupts;
+    const size_t columns = interrupts.cpu_ids.size();
+    json.begin_array("hardirqs_per_cpu");
+    for (size_t column = 0; interrupts.valid && column < columns; ++column) {
+        double total = 0.0;
+        for (size_t row = 0; row < interrupts.rows(); ++row) {
+            total += interrupts.rates[row * columns + column];
+        }
+        json.element(total, 1);
+    }
+    json.end_array();
+
+    // Busiest sources, kept sorted by insertion into a fixed array
+    constexpr size_t TOP_HARDIRQS = 8;
+    struct { size_t row; double total; } top[TOP_HARDIRQS];
+    size_t top_count = 0;
+    for (size_t row = 0; interrupts.valid && row < interrupts.rows(); ++row) {
+        const float *values = &interrupts.rates[row * columns];
+        double total = std::accumulate(values, values + columns, 0.0);
+        if (total <= 0.0 || (top_count == TOP_HARDIRQS && total <= top[TOP_HARDIRQS - 1].total)) continue;
+        size_t slot = std::min(top_count, TOP_HARDIRQS - 1);
+        for (; slot > 0 && top[slot - 1].total < total; --slot) top[slot] = top[slot - 1];
+        top[slot] = {row, total};
+        top_count = std::min(top_count + 1, TOP_HARDIRQS);
+    }
+    json.begin_array("top_hardirqs");
+    for (size_t i = 0; i < top_count; ++i) {
+        json.begin_object();
+        json.field("source", interrupts.labels[top[i].row]);
+        json.field("name", interrupts.names[top[i].row]);
+        json.field("total", top[i].total, 1);
+        json.end_object();
+    }
+    json.end_array();
+
+    json.begin_array("cpus");
+    for (int cpu : snapshot.softirqs.cpu_ids) {
+        json.element(cpu, 0);
+    }
+    json.end_array();
+    json.end_object();
+
+    json.end_object();
+    json.put('\n');
+}
+
+/**
+ * Writes a whole buffer to a descriptor, retrying on partial writes
+ * @return true on success, false on error (errno is set)
+ */
+bool write_all(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+// =============================================================================
+// PROMETHEUS EXPORTER
+// =============================================================================
+
+/**
+ * Builds the Prometheus text exposition format (version 0.0.4)
+ */
+struct ExpositionWriter : OutputBuffer {
+    std::string labels;  // Scratch for labels built from arbitrary strings
+
+    void text(const char *value) { put(value, strlen(value)); }
+
+    /** Appends name="value" to labels, escaping the value */
+    void append_label(const char *name, std::string_view value) {
+        if (!labels.empty()) labels += ',';
+        labels += name;
+        labels += "=\"";
+        for (char c : value) {
+            if (c == '\\' || c == '"') {
+                labels += '\\';
+                labels += c;
+            } else if (c == '\n') {
+                labels += "\\n";
+            } else {
+                labels += c;
+            }
+        }
+        labels += '"';
+    }
+
+    /** Sets labels to a device name (interface or disk) and, if given, a direction */
+    void device_labels(std::string_view device, const char *direction = nullptr) {
+        labels.clear();
+        append_label("device", device);
+        if (direction) append_label("direction", direction);
+    }
+
+    /** Sets labels to the mountpoint and fstype of a filesystem */
+    void filesystem_labels(const FilesystemUsage &filesystem) {
+        labels.clear();
+        append_label("mountpoint", filesystem.mount_point);
+        append_label("fstype", filesystem.fs_type);
+    }
+
+    /** Writes the HELP and TYPE lines that precede a metric's samples */
+    void header(const char *name, const char *type, const char *help) {
+        text("# HELP ");
+        text(name);
+        put(' ');
+        text(help);
+        text("\n# TYPE ");
+        text(name);
+        put(' ');
+        text(type);
+        put('\n');
+    }
+
+    /**
+     * Writes one sample line
+     * @param name Metric name
+     * @param labels Label pairs without braces, e.g. "state=\"user\"", or nullptr
+     * @param value Sample value
+     * @param decimals Digits after the decimal point
+     */
+    void sample(const char *name, const char *labels, double value, int decimals) {
+        text(name);
+        if (labels) {
+            put('{');
+            text(labels);
+            put('}');
+        }
+        put(' ');
+        number(value, decimals);
+        put('\n');
+    }
+
+    /** Writes a gauge with a single unlabelled sample */
+    void gauge(const char *name, const char *help, double value, int decimals) {
+        header(name, "gauge", help);
+        sample(name, nullptr, value, decimals);
+    }
+};
+
+/**
+ * Renders every metric of a snapshot in exposition format
+ * Unavailable metrics (negative values) are left out.
+ * @param snapshot Metrics to render
+ * @param out Writer to append to
+ */
+void write_snapshot_exposition(const Snapshot &snapshot, ExpositionWriter &out) {
+    char labels[64];
+
+    out.gauge("msysinfo_sample_interval_seconds", "Measured time between the last two samples.",
+              snapshot.interval, 3);
+    out.gauge("msysinfo_uptime_seconds", "System uptime.", snapshot.uptime, 2);
+
+    const CpuUsage &cpu = snapshot.cpu;
+    if (cpu.total >= 0) {
+        out.gauge("msysinfo_cpu_usage_percent", "Aggregate CPU busy time over the last interval.",
+                  cpu.total, 2);
+
+        const struct {
+            const char *state;
+            double value;
+        } states[] = {
+            {"user", cpu.breakdown.user}, {"nice", cpu.breakdown.nice},
+            {"system", cpu.breakdown.system}, {"irq", cpu.breakdown.irq},
+            {"softirq", cpu.breakdown.softirq}, {"steal", cpu.breakdown.steal},
+            {"guest", cpu.breakdown.guest}, {"iowait", cpu.breakdown.iowait},
+            {"idle", cpu.breakdown.idle},
+        };
+        out.header("msysinfo_cpu_state_percent", "gauge",
+                   "Share of aggregate CPU time spent in each state over the last interval.");
+        for (const auto &state : states) {
+            snprintf(labels, sizeof(labels), "state=\"%s\"", state.state);
+            out.sample("msysinfo_cpu_state_percent", labels, state.value, 2);
+        }
+
+        out.header("msysinfo_cpu_core_usage_percent", "gauge",
+                   "Busy time of each online core over the last interval.");
+        for (size_t core = 0; core < cpu.per_core.size(); ++core) {
+            if (cpu.per_core[core] < 0) continue;
+            snprintf(labels, sizeof(labels), "core=\"%d\"", cpu.core_ids[core]);
+            out.sample("msysinfo_cpu_core_usage_percent", labels, cpu.per_core[core], 2);
+        }
+    }
+
+    const SchedulerActivity &scheduler = snapshot.scheduler;
+    if (scheduler.load[0] >= 0) {
+        static const char *const windows[] = {"1m", "5m", "15m"};
+        const double cpus = (double)std::max<size_t>(cpu.per_core.size(), 1);
+        out.header("msysinfo_load_average", "gauge", "Load average from /proc/loadavg.");
+        for (int window = 0; window < 3; ++window) {
+            snprintf(labels, sizeof(labels), "window=\"%s\"", windows[window]);
+            out.sample("msysinfo_load_average", labels, scheduler.load[window], 2);
+        }
+        out.header("msysinfo_load_per_cpu", "gauge", "Load average divided by the online CPU count.");
+        for (int window = 0; window < 3; ++window) {
+            snprintf(labels, sizeof(labels), "window=\"%s\"", windows[window]);
+            out.sample("msysinfo_load_per_cpu", labels, scheduler.load[window] / cpus, 3);
+        }
+    }
+    if (cpu.total >= 0 || !cpu.per_core.empty()) {
+        out.gauge("msysinfo_procs_running", "Runnable tasks.", (double)scheduler.running, 0);
+        out.gauge("msysinfo_procs_blocked", "Tasks blocked waiting for I/O.",
+                  (double)scheduler.blocked, 0);
+    }
+    if (scheduler.rates_valid) {
+        out.gauge("msysinfo_context_switches_per_second", "Context switches per second.",
+                  scheduler.context_switches, 1);
+        out.gauge("msysinfo_interrupts_per_second", "Interrupts serviced per second.",
+                  scheduler.interrupts, 1);
+        out.gauge("msysinfo_forks_per_second", "Tasks created per second.", scheduler.forks, 1);
+    }
+
+    if (snapshot.ram_usage >= 0) {
+        out.gauge("msysinfo_memory_usage_percent", "Memory in use (MemTotal - MemAvailable).",
+                  snapshot.ram_usage, 2);
+
+        out.header("msysinfo_memory_bytes", "gauge", "Memory figures from /proc/meminfo.");
+        for (size_t field = 0; field < std::size(meminfo_keys); ++field) {
+            snprintf(labels, sizeof(labels), "field=\"%s\"", meminfo_keys[field].data());
+            out.sample("msysinfo_memory_bytes", labels,
+                       (double)(snapshot.memory.*meminfo_fields[field]) * 1024.0, 0);
+        }
+    }
+
+    static const char *const resource_names[PRESSURE_RESOURCES] = {"cpu", "memory", "io"};
+    if (snapshot.pressure[PRESSURE_CPU].some.avg10 >= 0 ||
+        snapshot.pressure[PRESSURE_MEMORY].some.avg10 >= 0 ||
+        snapshot.pressure[PRESSURE_IO].some.avg10 >= 0) {
+        out.header("msysinfo_pressure_stall_percent", "gauge",
+                   "Share of time tasks were stalled on a resource, from /proc/pressure.");
+        for (int resource = 0; resource < PRESSURE_RESOURCES; ++resource) {
+            const Pressure &pressure = snapshot.pressure[resource];
+            const struct {
+                const char *kind;
+                const char *window;
+                double value;
+            } samples[] = {
+                {"some", "10s", pressure.some.avg10}, {"some", "60s", pressure.some.avg60},
+                {"some", "interval", pressure.some_percent},
+                {"full", "10s", pressure.full.avg10}, {"full", "60s", pressure.full.avg60},
+                {"full", "interval", pressure.full_percent},
+            };
+            for (const auto &sample : samples) {
+                if (sample.value < 0) continue;
+                snprintf(labels, sizeof(labels), "resource=\"%s\",kind=\"%s\",window=\"%s\"",
+                         resource_names[resource], sample.kind, sample.window);
+                out.sample("msysinfo_pressure_stall_percent", labels, sample.value, 2);
+            }
+        }
+
+        out.header("msysinfo_pressure_stalled_seconds_total", "counter",
+                   "Cumulative time tasks were stalled on a resource.");
+        for (int resource = 0; resource < PRESSURE_RESOURCES; ++resource) {
+            const Pressure &pressure = snapshot.pressure[resource];
+            const PressureLine *lines[] = {&pressure.some, &pressure.full};
+            for (const PressureLine *line : lines) {
+                if (line->avg10 < 0) continue;
+                snprintf(labels, sizeof(labels), "resource=\"%s\",kind=\"%s\"",
+                         resource_names[resource], line == &pressure.some ? "some" : "full");
+                out.sample("msysinfo_pressure_stalled_seconds_total", labels,
+                           (double)line->total / 1e6, 6);
+            }
+        }
+    }
+
+    if (snapshot.vmstat.valid) {
+        out.header("msysinfo_vmstat_events_per_second", "gauge",
+                   "Paging and reclaim events per second, named after their /proc/vmstat counters.");
+        for (const auto &entry : vmstat_rates) {
+            snprintf(labels, sizeof(labels), "event=\"%s\"", entry.name);
+            out.sample("msysinfo_vmstat_events_per_second", labels, snapshot.vmstat.*entry.rate, 1);
+        }
+    }
+    if (!snapshot.filesystems.empty()) {
+        out.header("msysinfo_filesystem_usage_percent", "gauge", "Filesystem space in use.");
+        for (const FilesystemUsage &filesystem : snapshot.filesystems) {
+            if (filesystem.usage < 0) continue;
+            out.filesystem_labels(filesystem);
+            out.sample("msysinfo_filesystem_usage_percent", out.labels.c_str(), filesystem.usage, 2);
+        }
+        out.header("msysinfo_filesystem_hung", "gauge",
+                   "1 if statvfs() on the filesystem did not return in time.");
+        for (const FilesystemUsage &filesystem : snapshot.filesystems) {
+            out.filesystem_labels(filesystem);
+            out.sample("msysinfo_filesystem_hung", out.labels.c_str(), filesystem.hung ? 1.0 : 0.0, 0);
+        }
+    }
+    if (snapshot.temperature >= 0) {
+        out.gauge("msysinfo_cpu_temperature_celsius", "CPU temperature from the first thermal zone.",
+                  snapshot.temperature, 1);
+    }
+
+    out.gauge("msysinfo_network_receive_bytes_per_second",
+              "Bytes received per second across all interfaces except lo.",
+              (double)snapshot.rx_rate, 0);
+    out.gauge("msysinfo_network_transmit_bytes_per_second",
+              "Bytes sent per second across all interfaces except lo.",
+              (double)snapshot.tx_rate, 0);
+
+    if (!snapshot.interfaces.empty()) {
+        const struct {
+            const char *name;
+            const char *help;
+            double InterfaceRates::*receive;
+            double InterfaceRates::*transmit;
+            int decimals;
+        } interface_metrics[] = {
+            {"msysinfo_network_interface_bytes_per_second", "Bytes per second on each interface.",
+             &InterfaceRates::rx_bytes, &InterfaceRates::tx_bytes, 0},
+            {"msysinfo_network_interface_packets_per_second", "Packets per second on each interface.",
+             &InterfaceRates::rx_packets, &InterfaceRates::tx_packets, 1},
+            {"msysinfo_network_interface_errors_per_second", "Errors per second on each interface.",
+             &InterfaceRates::rx_errors, &InterfaceRates::tx_errors, 1},
+            {"msysinfo_network_interface_drops_per_second",
+             "Dropped packets per second on each interface.",
+             &InterfaceRates::rx_drops, &InterfaceRates::tx_drops, 1},
+            {"msysinfo_network_interface_fifo_errors_per_second",
+             "FIFO overruns per second on each interface.",
+             &InterfaceRates::rx_fifo, &InterfaceRates::tx_fifo, 1},
+        };
+        for (const auto &metric : interface_metrics) {
+            out.header(metric.name, "gauge", metric.help);
+            for (const InterfaceRates &rates : snapshot.interfaces) {
+                if (!rates.valid) continue;
+                // Interface names may contain any printable character
+                out.device_labels(rates.name, "receive");
+                out.sample(metric.name, out.labels.c_str(), rates.*metric.receive, metric.decimals);
+                out.device_labels(rates.name, "transmit");
+                out.sample(metric.name, out.labels.c_str(), rates.*metric.transmit, metric.decimals);
+            }
+        }
+    }
+
+    if (!snapshot.disk_io.empty()) {
+        const struct {
+            const char *name;
+            const char *help;
+            double DiskIo::*value;
+            int decimals;
+        } disk_metrics[] = {
+            {"msysinfo_disk_reads_per_second", "Reads completed per second.",
+             &DiskIo::reads_per_sec, 1},
+            {"msysinfo_disk_writes_per_second", "Writes completed per second.",
+             &DiskIo::writes_per_sec, 1},
+            {"msysinfo_disk_read_bytes_per_second", "Bytes read per second.",
+             &DiskIo::read_bytes_per_sec, 0},
+            {"msysinfo_disk_written_bytes_per_second", "Bytes written per second.",
+             &DiskIo::write_bytes_per_sec, 0},
+            {"msysinfo_disk_await_milliseconds",
+             "Average time per completed request over the last interval, queueing included.",
+             &DiskIo::await_ms, 2},
+            {"msysinfo_disk_utilization_percent",
+             "Share of the last interval with requests in flight.",
+             &DiskIo::utilization, 1},
+        };
+        for (const auto &metric : disk_metrics) {
+            out.header(metric.name, "gauge", metric.help);
+            for (const DiskIo &io : snapshot.disk_io) {
+                if (!io.valid) continue;
+                out.device_labels(io.name);
+                out.sample(metric.name, out.labels.c_str(), io.*metric.value, metric.decimals);
+            }
+        }
+    }
+
+    // Softirqs per type and CPU; hardware interrupts only per CPU, since
+    // one series per IRQ and CPU runs to hundreds of thousands on big hosts
+    const InterruptRates &softirqs = snapshot.softirqs;
+    if (softirqs.valid) {
+        const size_t columns = softirqs.cpu_ids.size();
+        out.header("msysinfo_softirqs_per_second", "gauge", "Softirqs handled per second on each CPU.");
+        for (size_t row = 0; row < softirqs.rows(); ++row) {
+            if (!softirqs.row_valid[row]) continue;
+            for (size_t column = 0; column < columns; ++column) {
+                snprintf(labels, sizeof(labels), "type=\"%s\",cpu=\"%d\"",
+                         softirqs.labels[row].c_str(), softirqs.cpu_ids[column]);
+                out.sample("msysinfo_softirqs_per_second", labels, softirqs.rates[row * columns + column], 1);
+            }
+        }
+    }
+    const InterruptRates &interrupts = snapshot.interrupts;
+    if (interrupts.valid) {
+        const size_t columns = interrupts.cpu_ids.size();
+        out.header("msysinfo_cpu_hardirqs_per_second", "gauge",
+                   "Hardware interrupts handled per second on each CPU, all sources together.");
+        for (size_t column = 0; column < columns; ++column) {
+            double total = 0.0;
+            for (size_t row = 0; row < interrupts.rows(); ++row) {
+                total += interrupts.rates[row * columns + column];
+            }
+            snprintf(labels, sizeof(labels), "cpu=\"%d\"", interrupts.cpu_ids[column]);
+            out.sample("msysinfo_cpu_hardirqs_per_second", labels, total, 1);
+        }
+    }
+}
+
+/**
+ * Minimal HTTP server for Prometheus scrapes
+ * The sampler thread renders the exposition text once per tick (publish())
+ * and hands it over through a SnapshotSlot, so scrapes are served from that
+ * cached text and never touch /proc, however many scrapers there are. The
+ * server runs on its own thread with a poll() loop over the listening
+ * socket and up to MAX_CLIENTS non-blocking connections.
+ */
+struct MetricsServer {
+    static constexpr size_t MAX_CLIENTS = 16;
+    static constexpr size_t MAX_REQUEST = 4096;
+    static constexpr double CLIENT_TIMEOUT = 5.0;  // Seconds to read a request and send the response
+
+    /** One HTTP connection: request being read, then response being sent */
+    struct Client {
+        int fd = -1;
+        double accepted = 0.0;  // CLOCK_MONOTONIC time of accept(), in seconds
+        std::string request;
+        std::string response;
+        size_t sent = 0;
+        bool responding = false;
+    };
+
+    SnapshotSlot<ExpositionWriter> exposition;  // Sampler thread -> server thread
+    int listen_fd = -1;
+    int stop_fd = create_eventfd();
+    std::vector<Client> clients;
+    std::thread thread;
+
+    /**
+     * Binds the listening socket
+     * @param address "host:port", "[ipv6]:port" or ":port" (loopback)
+     * Throws std::runtime_error or std::system_error on failure.
+     */
+    explicit MetricsServer(const std::string &address) {
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos) {
+            throw std::runtime_error("listen address '" + address + "' has no port");
+        }
+        std::string host = address.substr(0, colon);
+        std::string port = address.substr(colon + 1);
+        if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+        if (host.empty()) host = "127.0.0.1";
+
+        struct addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+        struct addrinfo *results = nullptr;
+        int status = getaddrinfo(host.c_str(), port.c_str(), &hints, &results);
+        if (status != 0) {
+            throw std::runtime_error("listen address '" + address + "': " + gai_strerror(status));
+        }
+
+        int error = 0;
+        for (struct addrinfo *candidate = results; candidate; candidate = candidate->ai_next) {
+            int fd = socket(candidate->ai_family, candidate->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                            candidate->ai_protocol);
+            if (fd < 0) {
+                error = errno;
+                continue;
+            }
+            int enable = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+            if (bind(fd, candidate->ai_addr, candidate->ai_addrlen) == 0 && listen(fd, 16) == 0) {
+                listen_fd = fd;
+                break;
+            }
+            error = errno;
+            close(fd);
+        }
+        freeaddrinfo(results);
+
+        if (listen_fd < 0) {
+            throw std::system_error(error, std::generic_category(), "listen on " + address);
+        }
+        clients.reserve(MAX_CLIENTS);
+    }
+
+    MetricsServer(const MetricsServer &) = delete;
+    MetricsServer &operator=(const MetricsServer &) = delete;
+
+    ~MetricsServer() {
+        stop();
+        for (Client &client : clients) close(client.fd);
+        close(listen_fd);
+        close(stop_fd);
+    }
+
+    void start() {
+        thread = std::thread([this] { run(); });
+    }
+
+    /** Asks the thread to finish and waits for it */
+    void stop() {
+        notify_eventfd(stop_fd);
+        if (thread.joinable()) thread.join();
+    }
+
+    /** Sampler thread: renders the exposition text for a new snapshot */
+    void publish(const Snapshot &snapshot) {
+        ExpositionWriter &out = exposition.back();
+        out.clear();
+        write_snapshot_exposition(snapshot, out);
+        exposition.publish();
+    }
+
+    /** Builds the response for a complete request header */
+    void respond(Client &client) {
+        exposition.consume();
+        const ExpositionWriter &text = exposition.front();
+
+        const char *status = "200 OK";
+        const char *content_type = "text/plain; version=0.0.4; charset=utf-8";
+        std::string_view body(text.data(), text.size());
+
+        std::string_view request(client.request);
+        bool is_get = request.substr(0, 4) == "GET " || request.substr(0, 5) == "HEAD ";
+        std::string_view target = request.substr(request.find(' ') + 1);
+        target = target.substr(0, target.find_first_of(" ?"));
+
+        if (!is_get) {
+            status = "405 Method Not Allowed";
+            content_type = "text/plain";
+            body = "Only GET is supported\n";
+        } else if (target != "/metrics" && target != "/") {
+            status = "404 Not Found";
+            content_type = "text/plain";
+            body = "Metrics are served at /metrics\n";
+        } else if (text.size() == 0) {
+            status = "503 Service Unavailable";
+            content_type = "text/plain";
+            body = "No sample collected yet\n";
+        }
+
+        char header[256];
+        int header_length = snprintf(header, sizeof(header),
+                                     "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+                                     "Connection: close\r\n\r\n",
+                                     status, content_type, body.size());
+        client.response.assign(header, header_length);
+        if (request.substr(0, 5) != "HEAD ") client.response.append(body);
+        client.sent = 0;
+        client.responding = true;
+    }
+
+    /**
+     * Advances one connection as far as it can go without blocking
+     * @return false once the connection is finished and should be closed
+     */
+    bool service(Client &client) {
+        if (!client.responding) {
+            char chunk[1024];
+            ssize_t bytes;
+            while ((bytes = read(client.fd, chunk, sizeof(chunk))) > 0) {
+                client.request.append(chunk, bytes);
+                if (client.request.size() > MAX_REQUEST) return false;
+            }
+            if (bytes == 0 || (bytes < 0 && errno != EAGAIN && errno != EINTR)) return false;
+            if (client.request.find("\r\n\r\n") == std::string::npos) return true;
+            respond(client);
+        }
+
+        while (client.sent < client.response.size()) {
+            ssize_t written = send(client.fd, client.response.data() + client.sent,
+                                   client.response.size() - client.sent, MSG_NOSIGNAL);
+            if (written < 0) return errno == EAGAIN || errno == EINTR;
+            client.sent += (size_t)written;
+        }
+        return false;
+    }
+
+    void run() {
+        std::vector<struct pollfd> fds;
+        fds.reserve(MAX_CLIENTS + 2);
+
+        while (true) {
+            fds.clear();
+            fds.push_back({stop_fd, POLLIN, 0});
+            fds.push_back({listen_fd, (short)(clients.size() < MAX_CLIENTS ? POLLIN : 0), 0});
+            for (const Client &client : clients) {
+                fds.push_back({client.fd, (short)(client.responding ? POLLOUT : POLLIN), 0});
+            }
+
+            // Wake up in time to drop the oldest connection if it stalls,
+            // so idle peers cannot hold every slot
+            int timeout = -1;
+            if (!clients.empty()) {
+                double oldest = clients[0].accepted;
+                for (const Client &client : clients) oldest = std::min(oldest, client.accepted);
+                double remaining = oldest + CLIENT_TIMEOUT - monotonic_seconds();
+                timeout = remaining > 0.0 ? (int)(remaining * 1000.0) + 1 : 0;
+            }
+
+            if (poll(fds.data(), fds.size(), timeout) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            if (fds[0].revents) return;
+
+            // Service existing connections, dropping finished and expired ones
+            const double now = monotonic_seconds();
+            size_t kept = 0;
+            for (size_t i = 0; i < clients.size(); ++i) {
+                bool alive = fds[i + 2].revents == 0 || service(clients[i]);
+                if (alive && now - clients[i].accepted >= CLIENT_TIMEOUT) alive = false;
+                if (alive) {
+                    if (kept != i) clients[kept] = std::move(clients[i]);
+                    kept++;
+                } else {
+                    close(clients[i].fd);
+                }
+            }
+            clients.resize(kept);
+
+            // Accept new connections
+            if (fds[1].revents & POLLIN) {
+                while (clients.size() < MAX_CLIENTS) {
+                    int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (fd < 0) break;
+                    clients.emplace_back();
+                    clients.back().fd = fd;
+                    clients.back().accepted = now;
+                }
+            }
+        }
+    }
+};
+
+// =============================================================================
+// SHARED MEMORY PUBLISHER
+// =============================================================================
+
+/**
+ * Publishes every snapshot into a POSIX shared memory segment
+ * The layout and the reader side live in msysinfo_shm.h. Writes follow the
+ * seqlock protocol: the sequence becomes odd, the payload is stored word by
+ * word, then the sequence becomes even again with release ordering. The
+ * monitor never waits for readers. An advisory lock on the segment keeps a
+ * second monitor from publishing into the same name.
+ */
+struct ShmPublisher {
+    std::string name;
+    int fd = -1;
+    msysinfo_shm_segment *segment = nullptr;
+    msysinfo_shm_metrics staging = {};  // Built here, then copied into the segment
+
+    /**
+     * Creates (or takes over) and maps the segment
+     * @param segment_name Name for shm_open(); a leading '/' is added if missing
+     * Throws std::system_error or std::runtime_error on failure.
+     */
+    explicit ShmPublisher(const std::string &segment_name)
+        : name(segment_name.empty() || segment_name[0] != '/' ? "/" + segment_name : segment_name) {
+        fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+        if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+            close(fd);
+            throw std::runtime_error("shared memory segment " + name + " is used by another monitor");
+        }
+        if (ftruncate(fd, sizeof(msysinfo_shm_segment)) != 0) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "ftruncate " + name);
+        }
+
+        void *mapping = mmap(nullptr, sizeof(msysinfo_shm_segment), PROT_READ | PROT_WRITE,
+                             MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "mmap " + name);
+        }
+        segment = static_cast<msysinfo_shm_segment *>(mapping);
+
+        // Readers check the magic first, so it is written last
+        memset(segment, 0, sizeof(*segment));
+        segment->version = MSYSINFO_SHM_VERSION;
+        segment->size = sizeof(msysinfo_shm_segment);
+        __atomic_store_n(&segment->magic, MSYSINFO_SHM_MAGIC, __ATOMIC_RELEASE);
+    }
+
+    ShmPublisher(const ShmPublisher &) = delete;
+    ShmPublisher &operator=(const ShmPublisher &) = delete;
+
+    /**
+     * Marks the segment stopped for readers that already mapped it, then
+     * removes its name so that new readers cannot open it
+     */
+    ~ShmPublisher() {
+        __atomic_store_n(&segment->state, (uint64_t)MSYSINFO_SHM_STATE_STOPPED, __ATOMIC_RELEASE);
+        munmap(segment, sizeof(msysinfo_shm_segment));
+        shm_unlink(name.c_str());
+        close(fd);
+    }
+
+    /** Sampler thread: writes a snapshot into the segment */
+    void publish(const Snapshot &snapshot) {
+        const CpuUsage &cpu = snapshot.cpu;
+        staging.wall_time = snapshot.wall_time;
+        staging.monotonic_time = snapshot.timestamp;
+        staging.interval = snapshot.interval;
+        staging.uptime = snapshot.uptime;
+        // States are unavailable (negative) whenever the total is
+        const CpuBreakdown states = cpu.total >= 0 ? cpu.breakdown
+                                                   : CpuBreakdown{-1, -1, -1, -1, -1, -1, -1, -1, -1};
+        staging.cpu_total = cpu.total;
+        staging.cpu_user = states.user;
+        staging.cpu_nice = states.nice;
+        staging.cpu_system = states.system;
+        staging.cpu_irq = states.irq;
+        staging.cpu_softirq = states.softirq;
+        staging.cpu_steal = states.steal;
+        staging.cpu_guest = states.guest;
+        staging.cpu_iowait = states.iowait;
+        staging.cpu_idle = states.idle;
+        staging.ram_usage = snapshot.ram_usage;
+        staging.disk_usage = snapshot.disk_usage;
+        staging.temperature = snapshot.temperature;
+        staging.rx_bytes_per_sec = (double)snapshot.rx_rate;
+        staging.tx_bytes_per_sec = (double)snapshot.tx_rate;
+        // Indexed by CPU number; offline CPUs below the highest online one are -1
+        staging.core_count = 0;
+        for (size_t core = 0; core < cpu.per_core.size(); ++core) {
+            size_t id = (size_t)cpu.core_ids[core];
+            if (id >= MSYSINFO_SHM_MAX_CORES) break;
+            for (size_t gap = staging.core_count; gap < id; ++gap) staging.core_usage[gap] = -1.0;
+            staging.core_usage[id] = cpu.per_core[core];
+            staging.core_count = id + 1;
+        }
+
+        // Only the used part of the core array is copied
+        const size_t words = (offsetof(msysinfo_shm_metrics, core_usage) +
+                              staging.core_count * sizeof(double)) / sizeof(uint64_t);
+        const uint64_t *source = reinterpret_cast<const uint64_t *>(&staging);
+        uint64_t *target = reinterpret_cast<uint64_t *>(&segment->metrics);
+
+        uint64_t sequence = segment->sequence;  // Only this thread writes it
+        __atomic_store_n(&segment->sequence, sequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        for (size_t i = 0; i < words; ++i) {
+            __atomic_store_n(&target[i], source[i], __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&segment->sequence, sequence + 2, __ATOMIC_RELEASE);
+    }
+};
+
+// =============================================================================
+// BENCHMARKS
 // =============================================================================
 
 /**
- * Reads CPU usage percentage from /proc/stat
- * Uses delta calculation between calls to get accurate usage
- * @return CPU usage as percentage (0.0-100.0), or 0.0 on first call
+ * Original stream-based /proc/net/dev parser, kept as the benchmark baseline
  */
-double get_cpu_usage() {
-    static bool first_call = true;
-    static ull last_total = 0, last_idle = 0;
+std::map<std::string, std::pair<ull, ull>> legacy_parse_network_stats(std::istream &dev_file) {
+    std::map<std::string, std::pair<ull, ull>> interface_stats;
 
-    std::ifstream file("/proc/stat");
-    if (!file.is_open()) {
-        return -1.0; // Error reading file
-    }
+    std::string line;
+    std::getline(dev_file, line);
+    std::getline(dev_file, line);
 
-    std::string cpu_label;
-    ull user, nice, system, idle, iowait, irq, softirq, steal;
-    
-    file >> cpu_label >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
-
-    // Calculate total and idle time
-    ull idle_time = idle + iowait;
-    ull non_idle_time = user + nice + system + irq + softirq + steal;
-    ull total_time = idle_time + non_idle_time;
-
-    // First call: just store values, can't calculate usage yet
-    if (first_call) {
-        last_total = total_time;
-        last_idle = idle_time;
-        first_call = false;
-        return 0.0;
-    }
+    while (std::getline(dev_file, line)) {
+        std::istringstream line_stream(line);
+        std::string interface_name;
+
+        if (!(line_stream >> interface_name)) continue;
+        if (!interface_name.empty() && interface_name.back() == ':') {
+            interface_name.pop_back();
+        }
 
-    // Calculate deltas since last call
-    ull total_delta = total_time - last_total;
-    ull idle_delta = idle_time - last_idle;
+        ull rx_bytes = 0, tx_bytes = 0;
+        std::string remaining_line;
+        std::getline(line_stream, remaining_line);
+        std::istringstream stats_stream(remaining_line);
 
-    // Store current values for next call
-    last_total = total_time;
-    last_idle = idle_time;
+        stats_stream >> rx_bytes;
+        for (int i = 0; i < 7; ++i) {
+            ull temp_value;
+            stats_stream >> temp_value;
+        }
+        stats_stream >> tx_bytes;
 
-    // Avoid division by zero
-    if (total_delta == 0) return 0.0;
+        interface_stats[interface_name] = {rx_bytes, tx_bytes};
+    }
 
-    // Calculate CPU usage percentage
-    return (100.0 * (total_delta - idle_delta)) / total_delta;
+    return interface_stats;
 }
 
 /**
- * Reads RAM usage percentage from /proc/meminfo
- * @return RAM usage as percentage (0.0-100.0), or -1.0 on error
+ * Original stream-based /proc/meminfo parser, kept as the benchmark baseline
  */
-double get_ram_usage() {
-    std::ifstream meminfo("/proc/meminfo");
-    if (!meminfo.is_open()) {
-        return -1.0;
-    }
-
+double legacy_parse_ram_usage(std::istream &meminfo) {
     std::string key, unit;
     unsigned long value;
     unsigned long mem_total = 0, mem_available = 0;
 
-    // Parse meminfo file to find total and available memory
     while (meminfo >> key >> value >> unit) {
         if (key == "MemTotal:") {
             mem_total = value;
         } else if (key == "MemAvailable:") {
             mem_available = value;
-            break; // We have both values we need
+            break;
         }
     }
 
     if (mem_total == 0) return -1.0;
-
-    // Calculate used memory and return as percentage
     double used_memory = mem_total - mem_available;
     return (used_memory * 100.0) / mem_total;
 }
 
 /**
- * Reads system uptime in seconds from /proc/uptime
- * @return Uptime in seconds, or 0.0 on error
+ * parse_meminfo() with the keys compared one by one instead of through the
+ * perfect hash, as the baseline for the key lookup
  */
-double get_uptime_seconds() {
-    std::ifstream file("/proc/uptime");
-    if (!file.is_open()) {
-        return 0.0;
-    }
+bool compare_chain_parse_meminfo(const char *data, size_t size, MemoryInfo &memory) {
+    TextScanner scanner(data, size);
+    memory = MemoryInfo{};
 
-    double uptime = 0.0;
-    file >> uptime;
-    return uptime;
+    do {
+        std::string_view key = scanner.next_word(':');
+        for (size_t field = 0; field < std::size(meminfo_keys); ++field) {
+            if (key == meminfo_keys[field]) {
+                memory.*meminfo_fields[field] = scanner.next_u64();
+                break;
+            }
+        }
+    } while (scanner.next_line());
+
+    return memory.total > 0;
 }
 
 /**
- * Reads disk usage percentage for a given path
- * @param path Filesystem path to check (default: root "/")
- * @return Disk usage as percentage (0.0-100.0), or -1.0 on error
+ * Times a callable over a fixed number of iterations
+ * @return Average nanoseconds per call
  */
-double get_disk_usage(const char *path = "/") {
-    struct statvfs filesystem_stats;
-    
-    if (statvfs(path, &filesystem_stats) != 0) {
-        return -1.0; // Error getting filesystem stats
+template <typename Function>
+double time_per_call(int iterations, Function &&function) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        function();
     }
-
-    // Calculate total and available space in bytes
-    ull total_space = (ull)filesystem_stats.f_blocks * filesystem_stats.f_frsize;
-    ull available_space = (ull)filesystem_stats.f_bavail * filesystem_stats.f_frsize;
-
-    if (total_space == 0) return 0.0;
-
-    // Calculate used space percentage
-    double used_percentage = (double)(total_space - available_space) * 100.0 / (double)total_space;
-    return used_percentage;
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / iterations;
 }
 
 /**
- * Gets the system hostname
- * @return Hostname as string, or empty string on error
+ * Builds /proc/net/dev text for made-up interfaces
+ * @param count Number of interfaces
  */
-std::string get_hostname() {
-    char hostname_buffer[256];
-    if (gethostname(hostname_buffer, sizeof(hostname_buffer)) == 0) {
-        return std::string(hostname_buffer);
+std::string synthetic_net_dev(size_t count) {
+    std::string text = "Inter-|   Receive                                                |  Transmit\n"
+                       " face |bytes    packets errs drop fifo frame compressed multicast|"
+                       "bytes    packets errs drop fifo colls carrier compressed\n";
+    char line[256];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(line, sizeof(line),
+                 "veth%06zu: %llu %llu 0 %zu 0 0 0 0 %llu %llu 0 0 0 0 0 0\n", i,
+                 123456789ULL * (i + 1), 98765ULL * (i + 1), i % 7, 987654321ULL * (i + 1),
+                 56789ULL * (i + 1));
+        text += line;
     }
-    return "Unknown";
+    return text;
 }
 
 /**
- * Gets the current username
- * @return Username as string, or empty string on error
+ * Builds an IFLA_STATS_LINK_64 stats dump reply for made-up interfaces,
+ * with the same layout the kernel sends, as one buffer
+ * @param count Number of interfaces, with ifindex 1..count
+ * @param sequence Sequence number to stamp on every message
  */
-std::string get_username() {
-    struct passwd *user_info = getpwuid(getuid());
-    if (user_info) {
-        return std::string(user_info->pw_name);
+std::string synthetic_stats_dump(size_t count, uint32_t sequence) {
+    const size_t header_space = NLMSG_ALIGN(sizeof(struct if_stats_msg));
+    const size_t message_length = NLMSG_LENGTH(header_space + RTA_SPACE(sizeof(struct rtnl_link_stats64)));
+    std::string dump;
+    for (size_t i = 0; i < count; ++i) {
+        std::string message(NLMSG_ALIGN(message_length), '\0');
+        struct nlmsghdr *header = (struct nlmsghdr *)&message[0];
+        header->nlmsg_len = (uint32_t)message_length;
+        header->nlmsg_type = RTM_NEWSTATS;
+        header->nlmsg_flags = NLM_F_MULTI;
+        header->nlmsg_seq = sequence;
+
+        struct if_stats_msg *stats_message = (struct if_stats_msg *)NLMSG_DATA(header);
+        stats_message->ifindex = (uint32_t)i + 1;
+        stats_message->filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64);
+
+        struct rtattr *attribute = (struct rtattr *)((char *)stats_message + header_space);
+        attribute->rta_type = IFLA_STATS_LINK_64;
+        attribute->rta_len = (unsigned short)RTA_LENGTH(sizeof(struct rtnl_link_stats64));
+        struct rtnl_link_stats64 stats = {};
+        stats.rx_bytes = 123456789ULL * (i + 1);
+        stats.rx_packets = 98765ULL * (i + 1);
+        stats.rx_dropped = i % 7;
+        stats.tx_bytes = 987654321ULL * (i + 1);
+        stats.tx_packets = 56789ULL * (i + 1);
+        memcpy(RTA_DATA(attribute), &stats, sizeof(stats));
+        dump += message;
     }
-    return "Unknown";
+
+    struct nlmsghdr done = {};
+    done.nlmsg_len = NLMSG_LENGTH(sizeof(int));
+    done.nlmsg_type = NLMSG_DONE;
+    done.nlmsg_flags = NLM_F_MULTI;
+    done.nlmsg_seq = sequence;
+    dump.append((const char *)&done, sizeof(done));
+    dump.append(NLMSG_ALIGN(sizeof(int)), '\0');
+    return dump;
 }
 
 /**
- * Attempts to read CPU temperature from thermal zones
- * Tries thermal_zone0 through thermal_zone9
- * @return Temperature in Celsius, or -1.0 if not available
+ * Adds a software network interface over rtnetlink
+ * @param fd NETLINK_ROUTE socket
+ * @param name Interface name
+ * @param kind Link type, e.g. "dummy"
+ * @param sequence Request sequence number
+ * @return true once the kernel acknowledged the new interface
  */
-double get_cpu_temperature() {
-    for (int zone = 0; zone < 10; ++zone) {
-        std::string thermal_path = "/sys/class/thermal/thermal_zone" + std::to_string(zone) + "/temp";
-        std::ifstream temp_file(thermal_path);
-        
-        if (!temp_file.is_open()) continue;
+bool add_software_link(int fd, const char *name, const char *kind, uint32_t sequence) {
+    struct {
+        struct nlmsghdr header;
+        struct ifinfomsg info;
+        char attributes[64];
+    } request = {};
+    request.header.nlmsg_type = RTM_NEWLINK;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_CREATE | NLM_F_EXCL | NLM_F_ACK;
+    request.header.nlmsg_seq = sequence;
+    request.info.ifi_family = AF_UNSPEC;
 
-        long temperature_value = 0;
-        if (temp_file >> temperature_value) {
-            // Most systems report temperature in millidegrees Celsius
-            if (temperature_value > 1000) {
-                return temperature_value / 1000.0;
-            }
-            return (double)temperature_value;
-        }
+    size_t length = NLMSG_LENGTH(sizeof(request.info));
+    auto append = [&](unsigned short type, const void *data, size_t size) {
+        struct rtattr *attribute = (struct rtattr *)((char *)&request + NLMSG_ALIGN(length));
+        attribute->rta_type = type;
+        attribute->rta_len = (unsigned short)RTA_LENGTH(size);
+        if (size) memcpy(RTA_DATA(attribute), data, size);
+        length = NLMSG_ALIGN(length) + RTA_ALIGN(attribute->rta_len);
+        return attribute;
+    };
+    append(IFLA_IFNAME, name, strlen(name) + 1);
+    struct rtattr *link_info = append(IFLA_LINKINFO, nullptr, 0);
+    append(IFLA_INFO_KIND, kind, strlen(kind));
+    link_info->rta_len = (unsigned short)((char *)&request + length - (char *)link_info);
+    request.header.nlmsg_len = (uint32_t)length;
+
+    struct sockaddr_nl kernel = {};
+    kernel.nl_family = AF_NETLINK;
+    if (sendto(fd, &request, length, 0, (struct sockaddr *)&kernel, sizeof(kernel)) < 0) return false;
+
+    char reply[512];
+    ssize_t received = recv(fd, reply, sizeof(reply), 0);
+    const struct nlmsghdr *header = (const struct nlmsghdr *)reply;
+    if (received < (ssize_t)NLMSG_LENGTH(sizeof(struct nlmsgerr)) || header->nlmsg_type != NLMSG_ERROR) {
+        return false;
     }
-    return -1.0; // Temperature not available
+    return ((const struct nlmsgerr *)NLMSG_DATA(header))->error == 0;
 }
 
 /**
- * Reads network interface statistics from /proc/net/dev
- * @return Map of interface name to {rx_bytes, tx_bytes}
+ * Times one tick of both network counter backends, kernel side included,
+ * for growing interface counts
+ * Runs in a child process with a private network namespace, so that the
+ * interfaces it adds (dummy, or bridges where the dummy driver is missing)
+ * disappear with it and never show up on the host. Needs CAP_NET_ADMIN or
+ * unprivileged user namespaces.
+ * @return false if no interfaces could be added
  */
-std::map<std::string, std::pair<ull, ull>> get_network_stats() {
-    std::map<std::string, std::pair<ull, ull>> interface_stats;
-    std::ifstream dev_file("/proc/net/dev");
-    
-    if (!dev_file.is_open()) {
-        return interface_stats; // Return empty map on error
+bool run_network_kernel_benchmark() {
+    std::cout.flush();
+    pid_t child = fork();
+    if (child < 0) return false;
+    if (child > 0) {
+        int status = 0;
+        while (waitpid(child, &status, 0) < 0 && errno == EINTR) {}
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
     }
 
-    std::string line;
-    // Skip the two header lines
-    std::getline(dev_file, line);
-    std::getline(dev_file, line);
+    if (unshare(CLONE_NEWNET) != 0 && unshare(CLONE_NEWUSER | CLONE_NEWNET) != 0) _exit(1);
 
-    // Parse each network interface line
-    while (std::getline(dev_file, line)) {
-        std::istringstream line_stream(line);
-        std::string interface_name;
-        
-        if (!(line_stream >> interface_name)) continue;
+    // Opened inside the namespace, so both only see its interfaces
+    int link_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    ProcFile dev_file("/proc/net/dev", 16384);
+    NetlinkLinkStats netlink;
+    std::vector<InterfaceStats> interfaces;
+    volatile size_t sink = 0;
 
-        // Remove the trailing colon from interface name
-        if (!interface_name.empty() && interface_name.back() == ':') {
-            interface_name.pop_back();
+    const char *kind = "dummy";
+    char name[IFNAMSIZ];
+    size_t added = 0;
+    bool printed_header = false;
+    for (size_t count : {16, 256, 1024, 4096}) {
+        for (; added < count; ++added) {
+            snprintf(name, sizeof(name), "bench%zu", added);
+            if (add_software_link(link_fd, name, kind, (uint32_t)added + 1)) continue;
+            if (added > 0 || strcmp(kind, "dummy") != 0) break;
+            kind = "bridge";
+            if (!add_software_link(link_fd, name, kind, (uint32_t)added + 1)) break;
         }
+        if (added < count) break;
 
-        ull rx_bytes = 0, tx_bytes = 0;
-        
-        // Parse the rest of the line to get rx and tx bytes
-        std::string remaining_line;
-        std::getline(line_stream, remaining_line);
-        std::istringstream stats_stream(remaining_line);
-        
-        stats_stream >> rx_bytes; // First value is rx_bytes
-        
-        // Skip 7 values to get to tx_bytes (9th value after interface name)
-        for (int i = 0; i < 7; ++i) {
-            ull temp_value;
-            stats_stream >> temp_value;
+        if (!printed_header) {
+            std::cout << "Network counters, read + parse per tick (" << kind
+                      << " interfaces in a private network namespace)" << std::endl;
+            std::cout << "  interfaces   net/dev pread   rtnetlink" << std::endl;
+            printed_header = true;
         }
-        
-        stats_stream >> tx_bytes; // This is tx_bytes
-        
-        interface_stats[interface_name] = {rx_bytes, tx_bytes};
+        const int iterations = (int)std::max<size_t>(20, 100000 / count);
+        netlink.read(interfaces);  // Learns the new names outside the timed loop
+
+        double text_ns = time_per_call(iterations, [&] {
+            if (dev_file.read()) parse_network_stats(dev_file.data(), dev_file.size(), interfaces);
+            sink = sink + interfaces.size();
+        });
+        double netlink_ns = time_per_call(iterations, [&] {
+            if (!netlink.read(interfaces)) interfaces.clear();
+            sink = sink + interfaces.size();
+        });
+        std::cout << "  " << std::setw(10) << count << "  " << std::fixed << std::setprecision(1)
+                  << std::setw(10) << text_ns / 1000.0 << " us" << std::setw(10)
+                  << netlink_ns / 1000.0 << " us" << std::endl;
     }
+    std::cout.flush();
+    _exit(printed_header ? 0 : 1);
+}
 
-    return interface_stats;
+/**
+ * Times both network counter backends on synthetic input for growing
+ * interface counts; parse cost only, to separate it from the kernel side
+ * measured by run_network_kernel_benchmark()
+ */
+void run_network_scaling_benchmark() {
+    std::vector<InterfaceStats> interfaces;
+    volatile size_t sink = 0;
+
+    std::cout << "Network counters, parse only per tick (synthetic interfaces)" << std::endl;
+    std::cout << "  interfaces   net/dev text    rtnetlink" << std::endl;
+    for (size_t count : {16, 256, 4096, 16384}) {
+        const std::string text = synthetic_net_dev(count);
+        const std::string dump = synthetic_stats_dump(count, 1);
+        std::vector<LinkName> links(count);
+        for (size_t i = 0; i < count; ++i) {
+            links[i].index = (int)i + 1;
+            snprintf(links[i].name, sizeof(links[i].name), "veth%06u", (unsigned)(i % 1000000));
+        }
+        unsigned generation = 0;
+        const int iterations = (int)std::max<size_t>(20, 400000 / count);
+
+        double text_ns = time_per_call(iterations, [&] {
+            parse_network_stats(text.data(), text.size(), interfaces);
+            sink = sink + interfaces.size();
+        });
+        double netlink_ns = time_per_call(iterations, [&] {
+            bool unknown_index = false;
+            interfaces.resize(links.size());
+            parse_link_stats(dump.data(), dump.size(), 1, links, ++generation, interfaces, unknown_index);
+            sink = sink + interfaces.size();
+        });
+        std::cout << "  " << std::setw(10) << count << "  " << std::fixed << std::setprecision(1)
+                  << std::setw(10) << text_ns / 1000.0 << " us" << std::setw(10)
+                  << netlink_ns / 1000.0 << " us" << std::endl;
+    }
+}
+
+/**
+ * Compares the stream-based parsers against the scanner-based ones, both
+ * end to end (read + parse) and on an in-memory copy of the file (parse only)
+ * @return Process exit code
+ */
+int run_benchmarks() {
+    const int iterations = 20000;
+    volatile double sink = 0.0; // Keeps results alive under optimisation
+
+    ProcFile dev_file("/proc/net/dev", 16384);
+    ProcFile meminfo("/proc/meminfo");
+    if (!dev_file.read() || !meminfo.read()) {
+        std::cerr << "Error: cannot read /proc/net/dev or /proc/meminfo" << std::endl;
+        return 1;
+    }
+    const std::string dev_text(dev_file.data(), dev_file.size());
+    const std::string meminfo_text(meminfo.data(), meminfo.size());
+    std::vector<InterfaceStats> interfaces;
+    NetlinkLinkStats netlink;
+    MemoryInfo memory;
+
+    struct Result {
+        const char *name;
+        double nanoseconds;
+    };
+    const Result results[] = {
+        {"net/dev  read+parse  ifstream", time_per_call(iterations, [&] {
+             std::ifstream file("/proc/net/dev");
+             sink = sink + legacy_parse_network_stats(file).size();
+         })},
+        {"net/dev  read+parse  pread   ", time_per_call(iterations, [&] {
+             get_network_stats(interfaces);
+             sink = sink + interfaces.size();
+         })},
+        {"net      read+parse  netlink ", time_per_call(iterations, [&] {
+             if (!netlink.read(interfaces)) interfaces.clear();
+             sink = sink + interfaces.size();
+         })},
+        {"net/dev  parse only  istream ", time_per_call(iterations, [&] {
+             std::istringstream stream(dev_text);
+             sink = sink + legacy_parse_network_stats(stream).size();
+         })},
+        {"net/dev  parse only  scanner ", time_per_call(iterations, [&] {
+             parse_network_stats(dev_text.data(), dev_text.size(), interfaces);
+             sink = sink + interfaces.size();
+         })},
+        {"meminfo  read+parse  ifstream", time_per_call(iterations, [&] {
+             std::ifstream file("/proc/meminfo");
+             sink = sink + legacy_parse_ram_usage(file);
+         })},
+        {"meminfo  read+parse  pread   ", time_per_call(iterations, [&] {
+             get_memory_info(memory);
+             sink = sink + memory.used_percent();
+         })},
+        {"meminfo  parse only  istream ", time_per_call(iterations, [&] {
+             std::istringstream stream(meminfo_text);
+             sink = sink + legacy_parse_ram_usage(stream);
+         })},
+        {"meminfo  parse only  compare ", time_per_call(iterations, [&] {
+             compare_chain_parse_meminfo(meminfo_text.data(), meminfo_text.size(), memory);
+             sink = sink + memory.used_percent();
+         })},
+        {"meminfo  parse only  hash    ", time_per_call(iterations, [&] {
+             parse_meminfo(meminfo_text.data(), meminfo_text.size(), memory);
+             sink = sink + memory.used_percent();
+         })},
+    };
+
+    std::cout << "Parser benchmark (" << iterations << " iterations, "
+              << interfaces.size() << " interfaces)" << std::endl;
+    for (const Result &result : results) {
+        std::cout << "  " << result.name << "  " << std::fixed << std::setprecision(1)
+                  << std::setw(10) << result.nanoseconds << " ns/op" << std::endl;
+    }
+    if (!netlink.available()) {
+        std::cout << "  (rtnetlink unavailable here; the netlink row measured a failed request)"
+                  << std::endl;
+    }
+
+    std::cout << std::endl;
+    if (!run_network_kernel_benchmark()) {
+        std::cout << "Network counters, read + parse per tick: skipped, no network namespace or"
+                     " interfaces could be created (needs CAP_NET_ADMIN)" << std::endl;
+    }
+    std::cout << std::endl;
+    run_network_scaling_benchmark();
+    return 0;
 }
 
 // =============================================================================
-// UTILITY FUNCTIONS
+// COMMAND LINE
 // =============================================================================
 
 /**
- * Converts bytes to human-readable format (B, KB, MB, GB, TB)
- * @param bytes Number of bytes to convert
- * @return Formatted string with appropriate unit
+ * Settings taken from the command line
  */
-std::string format_bytes(ull bytes) {
-    const char* units[] = {"B", "KB", "MB", "GB", "TB"};
-    double value = (double)bytes;
-    int unit_index = 0;
+struct Options {
+    bool bench = false;
+    bool json = false;  // Headless NDJSON output instead of the dashboard
+    std::string listen_address;  // Prometheus endpoint, empty if disabled
+    std::string shm_name;        // Shared memory segment, empty if disabled
+    bool adaptive = false;
+    bool interval_given = false;
+    std::chrono::milliseconds interval{1000};      // Fixed or fastest period
+    std::chrono::milliseconds max_interval{5000};  // Slowest adaptive period
+};
 
-    // Convert to appropriate unit
-    while (value >= 1024.0 && unit_index < 4) {
-        value /= 1024.0;
-        unit_index++;
+const std::chrono::milliseconds MIN_INTERVAL{50};
+
+/**
+ * Prints command line help
+ * @param program Name the program was invoked as
+ */
+void print_usage(const char *program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --interval DURATION      Refresh period, e.g. 1s, 250ms or 0.1 (default 1s,\n"
+              << "                           at least 50ms); the fastest period when adaptive\n"
+              << "  --adaptive               Sample fast while CPU usage changes quickly and back\n"
+              << "                           off while the host is idle (fastest default 100ms)\n"
+              << "  --max-interval DURATION  Slowest adaptive period (default 5s)\n"
+              << "  --json, --ndjson         Write one JSON object per tick to stdout instead of\n"
+              << "                           drawing the dashboard (no terminal needed)\n"
+              << "  --listen ADDRESS         Serve Prometheus metrics at http://ADDRESS/metrics,\n"
+              << "                           e.g. 127.0.0.1:9101 or :9101 (loopback)\n"
+              << "  --shm NAME               Publish every sample into the POSIX shared memory\n"
+              << "                           segment NAME (read it with msysinfo_shm.h)\n"
+              << "  --bench                  Run the /proc parser benchmark and exit\n"
+              << "  --help                   Show this help" << std::endl;
+}
+
+/**
+ * Parses a duration such as "250ms", "1.5s" or "2" (seconds)
+ * @param text Duration to parse
+ * @param duration Output
+ * @return true if text is a valid, positive duration
+ */
+bool parse_duration(const char *text, std::chrono::milliseconds &duration) {
+    char *end = nullptr;
+    double value = strtod(text, &end);
+    if (end == text || !(value > 0.0)) return false;
+
+    double scale = 1000.0;  // Seconds by default
+    if (strcmp(end, "ms") == 0) {
+        scale = 1.0;
+    } else if (strcmp(end, "s") != 0 && *end != '\0') {
+        return false;
     }
 
-    std::ostringstream formatted;
-    formatted << std::fixed << std::setprecision(2) << value << " " << units[unit_index];
-    return formatted.str();
+    duration = std::chrono::milliseconds((long long)std::llround(value * scale));
+    return true;
 }
 
 /**
- * Formats uptime seconds into human-readable format
- * @param seconds Uptime in seconds
- * @return Formatted string like "2d 5h 30m"
+ * Parses the command line
+ * @param argc Argument count from main()
+ * @param argv Argument vector from main()
+ * @param options Output
+ * @param exit_code Output, the status to exit with when returning false
+ * @return true to continue, false if the program should exit (after an
+ *         error, which has been reported, or after --help)
  */
-std::string format_uptime(double seconds) {
-    int total_seconds = (int)seconds;
-    int days = total_seconds / 86400;
-    int hours = (total_seconds % 86400) / 3600;
-    int minutes = (total_seconds % 3600) / 60;
+bool parse_options(int argc, char **argv, Options &options, int &exit_code) {
+    exit_code = 0;
+    for (int i = 1; i < argc; ++i) {
+        const char *argument = argv[i];
+        bool takes_value = strcmp(argument, "--interval") == 0 ||
+                           strcmp(argument, "--max-interval") == 0 ||
+                           strcmp(argument, "--listen") == 0 ||
+                           strcmp(argument, "--shm") == 0;
+        if (takes_value && i + 1 >= argc) {
+            std::cerr << "Error: " << argument << " needs a value" << std::endl;
+            exit_code = 1;
+            return false;
+        }
 
-    std::ostringstream formatted;
-    if (days > 0) {
-        formatted << days << "d " << hours << "h " << minutes << "m";
-    } else if (hours > 0) {
-        formatted << hours << "h " << minutes << "m";
-    } else {
-        formatted << minutes << "m " << (total_seconds % 60) << "s";
+        if (strcmp(argument, "--bench") == 0) {
+            options.bench = true;
+        } else if (strcmp(argument, "--json") == 0 || strcmp(argument, "--ndjson") == 0) {
+            options.json = true;
+        } else if (strcmp(argument, "--adaptive") == 0) {
+            options.adaptive = true;
+        } else if (strcmp(argument, "--listen") == 0) {
+            options.listen_address = argv[++i];
+        } else if (strcmp(argument, "--shm") == 0) {
+            options.shm_name = argv[++i];
+        } else if (takes_value) {
+            std::chrono::milliseconds duration;
+            if (!parse_duration(argv[++i], duration) || duration < MIN_INTERVAL) {
+                std::cerr << "Error: invalid " << argument << " '" << argv[i]
+                          << "' (expected a duration of at least 50ms)" << std::endl;
+                exit_code = 1;
+                return false;
+            }
+            if (strcmp(argument, "--interval") == 0) {
+                options.interval = duration;
+                options.interval_given = true;
+            } else {
+                options.max_interval = duration;
+            }
+        } else if (strcmp(argument, "--help") == 0 || strcmp(argument, "-h") == 0) {
+            print_usage(argv[0]);
+            return false;
+        } else {
+            std::cerr << "Error: unknown option '" << argument << "'" << std::endl;
+            print_usage(argv[0]);
+            exit_code = 1;
+            return false;
+        }
     }
-    
-    return formatted.str();
+
+    // Adaptive mode samples at 100ms while busy unless told otherwise
+    if (options.adaptive && !options.interval_given) {
+        options.interval = std::chrono::milliseconds(100);
+    }
+    options.max_interval = std::max(options.max_interval, options.interval);
+    return true;
 }
 
 // =============================================================================
-// UI DRAWING FUNCTIONS
+// MAIN PROGRAM
 // =============================================================================
 
 /**
- * Draws a box using Unicode box-drawing characters
- * @param y Top-left Y coordinate
- * @param x Top-left X coordinate  
- * @param height Box height
- * @param width Box width
+ * Publishers that receive every snapshot on the sampler thread
+ * Declared before the SamplerThread that references them, so that they
+ * outlive it.
  */
-void draw_box(int y, int x, int height, int width) {
-    // Draw corners
-    mvprintw(y, x, "┌");                           // Top-left
-    mvprintw(y, x + width - 1, "┐");               // Top-right
-    mvprintw(y + height - 1, x, "└");              // Bottom-left
-    mvprintw(y + height - 1, x + width - 1, "┘");  // Bottom-right
+struct Exporters {
+    std::unique_ptr<MetricsServer> metrics_server;
+    std::unique_ptr<ShmPublisher> shm_publisher;
+};
 
-    // Draw horizontal edges
-    for (int i = 1; i < width - 1; i++) {
-        mvprintw(y, x + i, "─");                   // Top edge
-        mvprintw(y + height - 1, x + i, "─");      // Bottom edge
+/**
+ * Applies the refresh and exporter options to the sampler before it starts
+ * @param sampler_thread Sampler to configure
+ * @param options Command line settings
+ * @param exporters Output, the exporters that were requested
+ */
+void configure_sampler(SamplerThread &sampler_thread, const Options &options, Exporters &exporters) {
+    sampler_thread.policy.fastest = options.interval;
+    sampler_thread.policy.slowest = options.adaptive ? options.max_interval : options.interval;
+    sampler_thread.policy.adaptive = options.adaptive;
+
+    if (!options.listen_address.empty()) {
+        exporters.metrics_server = std::make_unique<MetricsServer>(options.listen_address);
+        MetricsServer *server = exporters.metrics_server.get();
+        sampler_thread.observers.push_back([server](const Snapshot &snapshot) {
+            server->publish(snapshot);
+        });
+        server->start();
     }
 
-    // Draw vertical edges
-    for (int i = 1; i < height - 1; i++) {
-        mvprintw(y + i, x, "│");                   // Left edge
-        mvprintw(y + i, x + width - 1, "│");       // Right edge
+    if (!options.shm_name.empty()) {
+        exporters.shm_publisher = std::make_unique<ShmPublisher>(options.shm_name);
+        ShmPublisher *publisher = exporters.shm_publisher.get();
+        sampler_thread.observers.push_back([publisher](const Snapshot &snapshot) {
+            publisher->publish(snapshot);
+        });
     }
 }
 
 /**
- * Draws a modern progress bar with Unicode block characters
- * @param row Y position for the bar
- * @param col X position for the bar
- * @param percentage Value to display (0.0-100.0)
- * @param label Text label for the bar
+ * Headless mode: streams one NDJSON line per tick to stdout until a
+ * termination signal arrives or the reader goes away
+ * @return Process exit code
  */
-void draw_progress_bar(int row, int col, double percentage, const char* label) {
-    const int bar_width = 35;  // Width of the progress bar
-    int filled_blocks = (int)(percentage / 100.0 * bar_width);
+int run_ndjson(const Options &options) {
+    // A closed pipe shows up as EPIPE from write() instead of killing us
+    signal(SIGPIPE, SIG_IGN);
+    const int signal_fd = create_signalfd({SIGINT, SIGTERM, SIGHUP});
 
-    // Ensure percentage is within valid range
-    if (percentage < 0.0) percentage = 0.0;
-    if (percentage > 100.0) percentage = 100.0;
+    Exporters exporters;
+    SamplerThread sampler_thread;
+    configure_sampler(sampler_thread, options, exporters);
+    sampler_thread.start();
 
-    // Print label and opening bracket
-    mvprintw(row, col, "%s │", label);
+    JsonWriter json;
+    int exit_code = 0;
+    bool running = true;
+    while (running) {
+        struct pollfd fds[2] = {
+            {signal_fd, POLLIN, 0},
+            {sampler_thread.ready_fd, POLLIN, 0},
+        };
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            throw std::system_error(errno, std::generic_category(), "poll");
+        }
 
-    // Draw the progress bar
-    for (int i = 0; i < bar_width; i++) {
-        if (i < filled_blocks) {
-            addstr("█");  // Full block character
-        } else {
-            addstr(" ");  // Empty space
+        if (fds[0].revents & POLLIN) {
+            running = false;
+        } else if (fds[1].revents & POLLIN) {
+            drain_eventfd(sampler_thread.ready_fd);
+            if (!sampler_thread.slot.consume()) continue;
+
+            json.clear();
+            write_snapshot_json(sampler_thread.slot.front(), json);
+            if (!write_all(STDOUT_FILENO, json.data(), json.size())) {
+                // The reader closing the pipe is a normal way to stop
+                if (errno != EPIPE) {
+                    std::cerr << "Error: writing to stdout: " << strerror(errno) << std::endl;
+                    exit_code = 1;
+                }
+                running = false;
+            }
         }
     }
 
-    // Print closing bracket and percentage
-    printw("│ %6.2f%%", percentage);
+    sampler_thread.stop();
+    close(signal_fd);
+    return exit_code;
 }
 
-// =============================================================================
-// MAIN PROGRAM
-// =============================================================================
+int main(int argc, char **argv) {
+    Options options;
+    int exit_code = 0;
+    if (!parse_options(argc, argv, options, exit_code)) {
+        return exit_code;
+    }
+    if (options.bench) {
+        return run_benchmarks();
+    }
+    if (options.json) {
+        try {
+            return run_ndjson(options);
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
 
-int main() {
     try {
-        // Initialize for UTF-8 support and prime data collection
+        // Initialize for UTF-8 support
         setlocale(LC_ALL, "");
-        
-        // Get initial network stats for rate calculation
-        auto previous_network_stats = get_network_stats();
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        // Resize and termination signals arrive through a descriptor; this
+        // must happen before the sampler thread starts so it inherits the mask
+        const int signal_fd = create_signalfd({SIGWINCH, SIGINT, SIGTERM, SIGHUP});
+
+        // Start data collection
+        Exporters exporters;
+        SamplerThread sampler_thread;
+        configure_sampler(sampler_thread, options, exporters);
+        sampler_thread.start();
 
         // Initialize ncurses
         initscr();
-        if (has_colors()) {
-            start_color();
-            // You can add color pairs here if desired
-        }
+        init_color_pairs();
         noecho();        // Don't display typed characters
         curs_set(0);     // Hide cursor
-        nodelay(stdscr, TRUE); // Make getch() non-blocking
+        nodelay(stdscr, TRUE); // getch() only drains input poll() reported
 
-        // Main display loop
-        while (true) {
-            // Check for 'q' key to quit
-            int ch = getch();
-            if (ch == 'q' || ch == 'Q') {
-                break;
+        // Main display loop: sleeps until a key, a signal or a new snapshot
+        // arrives, and is never blocked by collectors
+        Dashboard dashboard;
+        NetworkTable network_table;
+        InterruptHeatmap interrupt_heatmap;
+        bool network_view = false;    // Table shown instead of the dashboard
+        bool interrupt_view = false;  // Heatmap shown instead of the dashboard
+        History history;  // Preallocated for History::CAPACITY slots
+        bool running = true;
+        while (running) {
+            struct pollfd fds[3] = {
+                {STDIN_FILENO, POLLIN, 0},
+                {signal_fd, POLLIN, 0},
+                {sampler_thread.ready_fd, POLLIN, 0},
+            };
+            if (poll(fds, 3, -1) < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "poll");
             }
 
-            // Collect system information
-            double cpu_usage = get_cpu_usage();
-            double ram_usage = get_ram_usage();
-            double uptime = get_uptime_seconds();
-            double disk_usage = get_disk_usage("/");
-            double temperature = get_cpu_temperature();
-            
-            std::string hostname = get_hostname();
-            std::string username = get_username();
-
-            // Calculate network transfer rates
-            auto current_network_stats = get_network_stats();
-            ull total_rx_rate = 0, total_tx_rate = 0;
-            const double time_interval = 1.0; // seconds
-
-            // Sum up rates from all interfaces (excluding loopback)
-            for (const auto &interface : current_network_stats) {
-                const std::string &interface_name = interface.first;
-                if (interface_name == "lo") continue; // Skip loopback interface
-
-                ull current_rx = interface.second.first;
-                ull current_tx = interface.second.second;
-                
-                // Get previous values (or current if interface is new)
-                ull previous_rx = 0, previous_tx = 0;
-                if (previous_network_stats.count(interface_name)) {
-                    previous_rx = previous_network_stats[interface_name].first;
-                    previous_tx = previous_network_stats[interface_name].second;
-                }
+            bool redraw = false;
 
-                // Calculate rate (handle counter wraparound)
-                ull rx_delta = (current_rx >= previous_rx) ? (current_rx - previous_rx) : 0;
-                ull tx_delta = (current_tx >= previous_tx) ? (current_tx - previous_tx) : 0;
-                
-                total_rx_rate += rx_delta;
-                total_tx_rate += tx_delta;
-            }
-            
-            previous_network_stats = current_network_stats;
-
-            // Clear screen and prepare for drawing
-            erase();
-
-            // Define box dimensions
-            const int box_x = 2;
-            const int box_y = 1;
-            const int box_width = 70;
-            const int box_height = 14;
-
-            // Draw the main container box
-            draw_box(box_y, box_x, box_height, box_width);
-
-            // Display system information inside the box
-            int current_row = box_y + 1;
-            
-            mvprintw(current_row++, box_x + 2, "Mini System Monitor");
-            mvprintw(current_row++, box_x + 2, "────────────────────────────────────────────────");
-            
-            mvprintw(current_row++, box_x + 2, "Host: %s", hostname.c_str());
-            mvprintw(current_row++, box_x + 2, "User: %s", username.c_str());
-            mvprintw(current_row++, box_x + 2, "Uptime: %s", format_uptime(uptime).c_str());
-
-            // Display temperature if available
-            if (temperature >= 0) {
-                mvprintw(current_row++, box_x + 2, "Temperature: %.1f°C", temperature);
-            } else {
-                mvprintw(current_row++, box_x + 2, "Temperature: Not available");
+            // Handle terminal resizes and termination requests
+            if (fds[1].revents & POLLIN) {
+                struct signalfd_siginfo info;
+                while (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+                    if (info.ssi_signo == SIGWINCH) {
+                        handle_resize();
+                        dashboard.invalidate();
+                        network_table.invalidate();
+                        interrupt_heatmap.invalidate();
+                        redraw = true;
+                    } else {
+                        running = false;
+                    }
+                }
             }
 
-            // Display network transfer rates
-            mvprintw(current_row++, box_x + 2, "Network: ↓ %s/s  ↑ %s/s",
-                     format_bytes(total_rx_rate / (ull)time_interval).c_str(),
-                     format_bytes(total_tx_rate / (ull)time_interval).c_str());
-
-            current_row++; // Add spacing before progress bars
-
-            // Draw progress bars for system usage
-            if (cpu_usage >= 0) {
-                draw_progress_bar(current_row++, box_x + 2, cpu_usage, "CPU  ");
-            }
-            
-            if (ram_usage >= 0) {
-                draw_progress_bar(current_row++, box_x + 2, ram_usage, "RAM  ");
-            }
-            
-            if (disk_usage >= 0) {
-                draw_progress_bar(current_row++, box_x + 2, disk_usage, "Disk ");
+            // Check for 'q' key to quit; a closed terminal also ends the loop
+            if (fds[0].revents & (POLLHUP | POLLERR)) {
+                running = false;
+            } else if (fds[0].revents & POLLIN) {
+                for (int ch = getch(); ch != ERR; ch = getch()) {
+                    if (ch == 'q' || ch == 'Q') {
+                        running = false;
+                    } else if (ch == 'n' || ch == 'N') {
+                        network_view = !network_view;
+                        interrupt_view = false;
+                        dashboard.invalidate();
+                        network_table.invalidate();
+                        interrupt_heatmap.invalidate();
+                        redraw = true;
+                    } else if (ch == 'i' || ch == 'I') {
+                        interrupt_view = !interrupt_view;
+                        network_view = false;
+                        dashboard.invalidate();
+                        network_table.invalidate();
+                        interrupt_heatmap.invalidate();
+                        redraw = true;
+                    } else if ((ch == 's' || ch == 'S') && network_view) {
+                        network_table.next_sort_column();
+                        redraw = true;
+                    } else if (ch == KEY_RESIZE) {
+                        dashboard.invalidate();
+                        network_table.invalidate();
+                        interrupt_heatmap.invalidate();
+                        redraw = true;
+                    }
+                }
             }
 
-            // Update the display
-            refresh();
+            // Pick up the latest snapshot
+            if (fds[2].revents & POLLIN) {
+                drain_eventfd(sampler_thread.ready_fd);
+                if (sampler_thread.slot.consume()) {
+                    history.record(sampler_thread.slot.front());
+                    redraw = true;
+                }
+            }
 
-            // Wait for next update cycle
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            const Snapshot &snapshot = sampler_thread.slot.front();
+            if (running && redraw && snapshot.valid) {
+                if (network_view) {
+                    network_table.render(snapshot);
+                } else if (interrupt_view) {
+                    interrupt_heatmap.render(snapshot);
+                } else {
+                    dashboard.render(snapshot, history);
+                }
+            }
         }
 
+        endwin();
+        sampler_thread.stop();
+        close(signal_fd);
+        std::cout << "System monitor stopped." << std::endl;
+        return 0;
+
     } catch (const std::exception &e) {
         // Clean up ncurses before showing error
         endwin();
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
-
-    // Clean up ncurses
-    endwin();
-    std::cout << "System monitor stopped." << std::endl;
-    return 0;
 }
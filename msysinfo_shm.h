@@ -0,0 +1,175 @@
+/**
+ * Mini System Monitor - shared memory snapshot reader
+ *
+ * Header-only library for local agents that want the monitor's current
+ * CPU/RAM/disk/network values without parsing /proc themselves. Start the
+ * monitor with --shm NAME; it then writes every sample into a POSIX shared
+ * memory segment with the fixed layout below, guarded by a seqlock.
+ *
+ * Opening the segment costs a few syscalls once. Every read afterwards is a
+ * plain memory copy: no syscalls, no parsing, and no locks that could block
+ * the monitor.
+ *
+ *     const struct msysinfo_shm_segment *segment = msysinfo_shm_open("/msysinfo");
+ *     struct msysinfo_shm_metrics metrics;
+ *     if (segment && msysinfo_shm_read(segment, &metrics) == 1) {
+ *         printf("cpu %.1f%%\n", metrics.cpu_total);
+ *     }
+ *     msysinfo_shm_close(segment);
+ *
+ * A monitor that exits cleanly marks the segment stopped, and reads then
+ * return MSYSINFO_SHM_STOPPED. A monitor that is killed or hangs leaves the
+ * last sample in place, so consumers that must not act on stale values
+ * compare monotonic_time plus a few intervals against their own
+ * CLOCK_MONOTONIC clock.
+ *
+ * Usable from C and C++. Link with -lrt on glibc older than 2.34.
+ */
+
+#ifndef MSYSINFO_SHM_H
+#define MSYSINFO_SHM_H
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MSYSINFO_SHM_MAGIC 0x4e49534dU  /* "MSIN" */
+#define MSYSINFO_SHM_VERSION 1U
+#define MSYSINFO_SHM_MAX_CORES 1024
+
+/* Values of msysinfo_shm_segment.state */
+#define MSYSINFO_SHM_STATE_RUNNING 0U
+#define MSYSINFO_SHM_STATE_STOPPED 1U
+
+/* msysinfo_shm_read() result when the monitor has exited */
+#define MSYSINFO_SHM_STOPPED (-1)
+
+/**
+ * One sample. Every field is 8 bytes wide so that the seqlock copy can move
+ * the payload as whole words. Unavailable metrics are negative.
+ */
+struct msysinfo_shm_metrics {
+    double wall_time;         /* Unix time of the sample, in seconds */
+    double monotonic_time;    /* CLOCK_MONOTONIC time of the sample, in seconds */
+    double interval;          /* Measured seconds since the previous sample */
+    double uptime;            /* System uptime in seconds */
+
+    double cpu_total;         /* Aggregate CPU busy percentage */
+    double cpu_user;          /* Percentages of CPU time per state */
+    double cpu_nice;
+    double cpu_system;
+    double cpu_irq;
+    double cpu_softirq;
+    double cpu_steal;
+    double cpu_guest;
+    double cpu_iowait;
+    double cpu_idle;
+
+    double ram_usage;         /* Memory in use, percent */
+    double disk_usage;        /* Root filesystem in use, percent */
+    double temperature;       /* CPU temperature in Celsius */
+    double rx_bytes_per_sec;  /* Network receive rate, excluding lo */
+    double tx_bytes_per_sec;  /* Network transmit rate, excluding lo */
+
+    uint64_t core_count;      /* Valid entries in core_usage: highest online CPU number + 1 */
+    double core_usage[MSYSINFO_SHM_MAX_CORES];  /* Busy percentage of CPU N at index N;
+                                                   negative for offline CPUs */
+};
+
+/**
+ * The whole segment. The header is written once when the monitor creates
+ * the segment; sequence is odd while a sample is being written and is
+ * advanced by two for every published sample. state becomes
+ * MSYSINFO_SHM_STATE_STOPPED when the monitor exits; the segment name is
+ * removed at the same time, but existing mappings stay valid.
+ */
+struct msysinfo_shm_segment {
+    uint32_t magic;     /* MSYSINFO_SHM_MAGIC */
+    uint32_t version;   /* MSYSINFO_SHM_VERSION */
+    uint64_t size;      /* sizeof(struct msysinfo_shm_segment) */
+    uint64_t sequence;  /* Seqlock counter; 0 until the first sample */
+    uint64_t state;     /* MSYSINFO_SHM_STATE_RUNNING or MSYSINFO_SHM_STATE_STOPPED */
+    uint64_t reserved[4];  /* Pads the header to one cache line */
+    struct msysinfo_shm_metrics metrics;
+};
+
+/**
+ * Maps an existing segment read-only
+ * @param name Segment name passed to the monitor's --shm option
+ * @return The segment, or NULL if it does not exist or has another layout
+ */
+static inline const struct msysinfo_shm_segment *msysinfo_shm_open(const char *name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    struct stat info;
+    void *mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(struct msysinfo_shm_segment)) {
+        mapping = mmap(NULL, sizeof(struct msysinfo_shm_segment), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) return NULL;
+
+    const struct msysinfo_shm_segment *segment = (const struct msysinfo_shm_segment *)mapping;
+    if (segment->magic != MSYSINFO_SHM_MAGIC || segment->version != MSYSINFO_SHM_VERSION ||
+        segment->size != sizeof(struct msysinfo_shm_segment)) {
+        munmap(mapping, sizeof(struct msysinfo_shm_segment));
+        return NULL;
+    }
+    return segment;
+}
+
+/** Unmaps a segment returned by msysinfo_shm_open(); NULL is ignored */
+static inline void msysinfo_shm_close(const struct msysinfo_shm_segment *segment) {
+    if (segment) munmap((void *)segment, sizeof(struct msysinfo_shm_segment));
+}
+
+/**
+ * Copies the latest consistent sample out of the segment
+ * Retries while the monitor is in the middle of writing, which takes well
+ * under a microsecond.
+ * @param segment Segment from msysinfo_shm_open()
+ * @param out Output
+ * @return 1 on success, 0 if no sample has been published yet or no
+ *         consistent copy could be taken, MSYSINFO_SHM_STOPPED if the
+ *         monitor has exited
+ */
+static inline int msysinfo_shm_read(const struct msysinfo_shm_segment *segment,
+                                    struct msysinfo_shm_metrics *out) {
+    const uint64_t *words = (const uint64_t *)&segment->metrics;
+    uint64_t *copy = (uint64_t *)out;
+    const size_t fixed_words = offsetof(struct msysinfo_shm_metrics, core_usage) / sizeof(uint64_t);
+
+    for (int attempt = 0; attempt < 10000; ++attempt) {
+        if (__atomic_load_n(&segment->state, __ATOMIC_ACQUIRE) == MSYSINFO_SHM_STATE_STOPPED) {
+            return MSYSINFO_SHM_STOPPED;
+        }
+        uint64_t before = __atomic_load_n(&segment->sequence, __ATOMIC_ACQUIRE);
+        if (before == 0) return 0;
+        if (before & 1) continue;
+
+        /* Relaxed word loads keep the racy copy well-defined; the fence and
+         * the second sequence load detect whether it was torn */
+        for (size_t i = 0; i < fixed_words; ++i) {
+            copy[i] = __atomic_load_n(&words[i], __ATOMIC_RELAXED);
+        }
+        size_t cores = out->core_count < MSYSINFO_SHM_MAX_CORES ? (size_t)out->core_count
+                                                                : MSYSINFO_SHM_MAX_CORES;
+        for (size_t i = fixed_words; i < fixed_words + cores; ++i) {
+            copy[i] = __atomic_load_n(&words[i], __ATOMIC_RELAXED);
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&segment->sequence, __ATOMIC_RELAXED) == before) {
+            out->core_count = cores;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#endif /* MSYSINFO_SHM_H */